@@ -0,0 +1,23 @@
+TARGET = quatter-cook
+
+LIBS += ../Quatter/Urho3D/lib/libUrho3D.a \
+    -lpthread \
+    -ldl \
+    -lGL
+
+QMAKE_CXXFLAGS += -std=c++1y
+
+INCLUDEPATH += \
+    ../Quatter/Urho3D/include \
+    ../Quatter/Urho3D/include/Urho3D/ThirdParty \
+
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+
+SOURCES += \
+    cook.cpp
+
+HEADERS += \
+    cook.h
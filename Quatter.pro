@@ -27,7 +27,24 @@ SOURCES += \
     effectmaster.cpp \
     square.cpp \
     yad.cpp \
-    indicator.cpp
+    indicator.cpp \
+    randomstream.cpp \
+    position.cpp \
+    history.cpp \
+    glowmodel.cpp \
+    lightmaster.cpp \
+    shadowmaster.cpp \
+    qualitymaster.cpp \
+    ecomaster.cpp \
+    savemaster.cpp \
+    cookedrouter.cpp \
+    benchmaster.cpp \
+    hudmaster.cpp \
+    shadermaster.cpp \
+    capturemaster.cpp \
+    replaymaster.cpp \
+    pickmaster.cpp \
+    sessionmaster.cpp
 
 HEADERS += \
     luckey.h \
@@ -40,7 +57,33 @@ HEADERS += \
     effectmaster.h \
     square.h \
     yad.h \
-    indicator.h
+    indicator.h \
+    randomstream.h \
+    position.h \
+    history.h \
+    recording.h \
+    glowmodel.h \
+    lightmaster.h \
+    shadowmaster.h \
+    qualitymaster.h \
+    ecomaster.h \
+    savemaster.h \
+    cookedrouter.h \
+    benchmaster.h \
+    hudmaster.h \
+    shadermaster.h \
+    capturemaster.h \
+    replaymaster.h \
+    pickmaster.h \
+    sessionmaster.h
+
+#Compress textures and optimize models ahead of time, needs quatter-cook from Cook.pro
+cook.commands = $$OUT_PWD/quatter-cook -o $$PWD/Resources/Cooked $$PWD/Resources $$PWD/Data $$PWD/CoreData
+QMAKE_EXTRA_TARGETS += cook
+
+#Cook and pack all resources into a single LZ4 compressed archive, which the game prefers over folders
+package.commands = $$OUT_PWD/quatter-cook -o $$PWD/Resources/Cooked -pack $$OUT_PWD/Quatter.pak $$PWD/Resources $$PWD/Data $$PWD/CoreData
+QMAKE_EXTRA_TARGETS += package
 
 unix {
     isEmpty(PREFIX) {
@@ -62,6 +105,12 @@ unix {
     pixmap.files = Resources/*
     pixmap.path = $$DATADIR/luckey/quatter/
 
+    exists($$OUT_PWD/Quatter.pak) {
+        pak.files = $$OUT_PWD/Quatter.pak
+        pak.path = $$DATADIR/luckey/quatter/
+        INSTALLS += pak
+    }
+
     desktop.files = quatter.desktop
     desktop.path = $$DATADIR/applications/
 
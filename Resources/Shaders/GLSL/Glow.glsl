@@ -0,0 +1,50 @@
+#include "Uniforms.glsl"
+#include "Transform.glsl"
+#include "ScreenPos.glsl"
+#include "Fog.glsl"
+
+#ifdef INSTANCED
+    attribute vec4 iTexCoord7;
+#endif
+#ifdef PULSE
+    // Morph target position deltas, baked by GlowModel::SetPulsingModel
+    attribute vec3 iTexCoord2;
+    uniform float cPulseFrequency;
+#endif
+
+varying vec4 vColor;
+varying vec4 vWorldPos;
+
+void VS()
+{
+    mat4 modelMatrix = iModelMatrix;
+    #ifdef PULSE
+        float pulse = 0.5 + 0.5 * sin(cPulseFrequency * cElapsedTime);
+        vec3 worldPos = (vec4(iPos.xyz + iTexCoord2 * pulse, 1.0) * modelMatrix).xyz;
+    #else
+        vec3 worldPos = GetWorldPos(modelMatrix);
+    #endif
+    gl_Position = GetClipPos(worldPos);
+    vWorldPos = vec4(worldPos, GetDepth(gl_Position));
+
+    // Instances carry their own color, single draws use the material's
+    #ifdef INSTANCED
+        vColor = iTexCoord7;
+    #else
+        vColor = vec4(1.0);
+    #endif
+}
+
+void PS()
+{
+    vec4 diffColor = cMatDiffColor * vColor;
+
+    // Get fog factor
+    #ifdef HEIGHTFOG
+        float fogFactor = GetHeightFogFactor(vWorldPos.w, vWorldPos.y);
+    #else
+        float fogFactor = GetFogFactor(vWorldPos.w);
+    #endif
+
+    gl_FragColor = vec4(GetFog(diffColor.rgb, fogFactor), diffColor.a);
+}
@@ -0,0 +1,76 @@
+#include "Uniforms.hlsl"
+#include "Samplers.hlsl"
+#include "Transform.hlsl"
+#include "Fog.hlsl"
+
+#ifdef PULSE
+    #ifndef D3D11
+        uniform float cPulseFrequency;
+    #elif defined(COMPILEVS)
+        cbuffer CustomVS : register(b6)
+        {
+            float cPulseFrequency;
+        }
+    #endif
+#endif
+
+void VS(float4 iPos : POSITION,
+    #ifdef SKINNED
+        float4 iBlendWeights : BLENDWEIGHT,
+        int4 iBlendIndices : BLENDINDICES,
+    #endif
+    #ifdef INSTANCED
+        float4x3 iModelInstance : TEXCOORD4,
+        float4 iInstanceColor : TEXCOORD7,
+    #endif
+    #ifdef PULSE
+        // Morph target position deltas, baked by GlowModel::SetPulsingModel
+        float3 iPulse : TEXCOORD2,
+    #endif
+    out float4 oColor : COLOR0,
+    out float4 oWorldPos : TEXCOORD2,
+    #if defined(D3D11) && defined(CLIPPLANE)
+        out float oClip : SV_CLIPDISTANCE0,
+    #endif
+    out float4 oPos : OUTPOSITION)
+{
+    float4x3 modelMatrix = iModelMatrix;
+    #ifdef PULSE
+        float pulse = 0.5 + 0.5 * sin(cPulseFrequency * cElapsedTime);
+        float3 worldPos = mul(float4(iPos.xyz + iPulse * pulse, 1.0), modelMatrix);
+    #else
+        float3 worldPos = GetWorldPos(modelMatrix);
+    #endif
+    oPos = GetClipPos(worldPos);
+    oWorldPos = float4(worldPos, GetDepth(oPos));
+
+    #if defined(D3D11) && defined(CLIPPLANE)
+        oClip = dot(oPos, cClipPlane);
+    #endif
+
+    // Instances carry their own color, single draws use the material's
+    #ifdef INSTANCED
+        oColor = iInstanceColor;
+    #else
+        oColor = float4(1.0, 1.0, 1.0, 1.0);
+    #endif
+}
+
+void PS(float4 iColor : COLOR0,
+    float4 iWorldPos: TEXCOORD2,
+    #if defined(D3D11) && defined(CLIPPLANE)
+        float iClip : SV_CLIPDISTANCE0,
+    #endif
+    out float4 oColor : OUTCOLOR0)
+{
+    float4 diffColor = cMatDiffColor * iColor;
+
+    // Get fog factor
+    #ifdef HEIGHTFOG
+        float fogFactor = GetHeightFogFactor(iWorldPos.w, iWorldPos.y);
+    #else
+        float fogFactor = GetFogFactor(iWorldPos.w);
+    #endif
+
+    oColor = float4(GetFog(diffColor.rgb, fogFactor), diffColor.a);
+}
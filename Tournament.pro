@@ -0,0 +1,22 @@
+TARGET = quatter-tournament
+
+LIBS += -lpthread
+
+QMAKE_CXXFLAGS += -std=c++1y
+
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+
+SOURCES += \
+    position.cpp \
+    randomstream.cpp \
+    player.cpp \
+    tournament.cpp
+
+HEADERS += \
+    position.h \
+    randomstream.h \
+    player.h \
+    tournament.h
@@ -0,0 +1,241 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "benchmaster.h"
+#include "capturemaster.h"
+#include "qualitymaster.h"
+#include "quattercam.h"
+#include "board.h"
+#include "piece.h"
+
+const char* BenchMaster::phaseNames_[BP_DONE]{"warmup", "orbit near", "orbit far", "game", "reset"};
+
+BenchMaster::BenchMaster(Context* context) : Master(context),
+    fileName_{FILES->GetCurrentDir() + "RenderBench.csv"},
+    random_{BENCH_SEED},
+    frames_{},
+    frameTimer_{},
+    phase_{BP_WARMUP},
+    phaseTime_{0.0f},
+    moveTime_{0.0f}
+{
+    const Vector<String>& arguments{GetArguments()};
+    for (unsigned a{0}; a + 1 < arguments.Size(); ++a)
+        if (arguments[a].ToLower() == "-benchout")
+            fileName_ = arguments[a + 1];
+}
+
+bool BenchMaster::IsRequested(const Vector<String>& arguments)
+{
+    for (const String& argument : arguments)
+        if (argument.ToLower() == BENCH_ARGUMENT)
+            return true;
+
+    return false;
+}
+
+void BenchMaster::Start()
+{
+    //Keep whatever level -quality asked for, the governor would blur the comparison
+    GetSubsystem<QualityMaster>()->SetAdaptive(false);
+
+    CAMERA->SetView(0.0f, 45.0f, ZOOM_MIN);
+    SetPhase(BP_WARMUP);
+    frames_.Reserve(static_cast<unsigned>(60.0f / BENCH_TIMESTEP));
+
+    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(BenchMaster, HandleUpdate));
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(BenchMaster, HandleEndFrame));
+    ENGINE->SetNextTimeStep(BENCH_TIMESTEP);
+    frameTimer_.Reset();
+
+    Log::Write(LOG_INFO, "Render benchmark at quality level " + String(GetSubsystem<QualityMaster>()->GetLevel()));
+}
+
+void BenchMaster::SetPhase(BenchPhase phase)
+{
+    phase_ = phase;
+    phaseTime_ = 0.0f;
+    moveTime_ = 0.0f;
+
+    switch (phase_){
+    case BP_ORBIT_NEAR:
+        CAMERA->SetDistance(ZOOM_MIN);
+        break;
+    case BP_ORBIT_FAR:
+        CAMERA->SetDistance(ZOOM_MAX);
+        break;
+    case BP_GAME:
+        CAMERA->ZoomToTable();
+        break;
+    case BP_RESET:
+        MC->Reset();
+        break;
+    case BP_DONE:
+        WriteResults();
+        GetSubsystem<CaptureMaster>()->Finish();
+        ENGINE->Exit();
+        break;
+    default:
+        break;
+    }
+}
+
+void BenchMaster::HandleUpdate(StringHash eventType, VariantMap& eventData)
+{ (void)eventType;
+
+    float timeStep{eventData[Update::P_TIMESTEP].GetFloat()};
+    phaseTime_ += timeStep;
+
+    switch (phase_){
+    case BP_WARMUP:
+        if (phaseTime_ > BENCH_WARMUP_TIME)
+            SetPhase(BP_ORBIT_NEAR);
+        break;
+    case BP_ORBIT_NEAR: case BP_ORBIT_FAR:
+        //One full turn while bobbing between the pitch limits
+        CAMERA->Rotate(Vector2(360.0f / BENCH_ORBIT_TIME,
+                               MC->Cosine(2.0f * M_PI / BENCH_ORBIT_TIME, -23.0f, 23.0f)) * timeStep);
+        if (phaseTime_ > BENCH_ORBIT_TIME)
+            SetPhase(phase_ == BP_ORBIT_NEAR ? BP_ORBIT_FAR : BP_GAME);
+        break;
+    case BP_GAME:
+        CAMERA->Rotate(Vector2(5.0f * timeStep, 0.0f));
+        moveTime_ += timeStep;
+        if (moveTime_ > BENCH_MOVE_TIME){
+
+            moveTime_ = 0.0f;
+            if (MC->GetGameState() == GameState::QUATTER || BOARD->IsFull())
+                SetPhase(BP_RESET);
+            else
+                PlayMove();
+        }
+        break;
+    case BP_RESET:
+        if (phaseTime_ > BENCH_RESET_TIME)
+            SetPhase(BP_DONE);
+        break;
+    default:
+        break;
+    }
+}
+//Picks a random free piece or puts the picked one on a random free square
+void BenchMaster::PlayMove()
+{
+    if (MC->InPickState()){
+
+        PODVector<Piece*> free{};
+        for (Piece* piece : MC->world_.pieces_)
+            if (piece->GetState() == PieceState::FREE || piece->GetState() == PieceState::SELECTED)
+                free.Push(piece);
+
+        if (!free.Empty())
+            free[random_.Int(free.Size())]->Pick();
+
+    } else if (MC->InPutState() && MC->GetPickedPiece()){
+
+        PODVector<Square*> free{};
+        for (Square* square : BOARD->GetSquares())
+            if (square->IsFree())
+                free.Push(square);
+
+        if (!free.Empty())
+            BOARD->PutPiece(MC->GetPickedPiece(), free[random_.Int(free.Size())]);
+    }
+}
+
+void BenchMaster::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    if (phase_ == BP_DONE)
+        return;
+
+    Renderer* renderer{GetSubsystem<Renderer>()};
+    BenchFrame frame{};
+    frame.phase_ = phase_;
+    frame.frameTime_ = frameTimer_.GetUSec(true) * 0.001f;
+    frame.drawCalls_ = GRAPHICS->GetNumBatches();
+    frame.batches_ = renderer->GetNumGeometries(true);
+    frame.primitives_ = GRAPHICS->GetNumPrimitives();
+    frame.lights_ = renderer->GetNumLights(true);
+    frame.shadowMaps_ = renderer->GetNumShadowMaps(true);
+    frames_.Push(frame);
+
+    //Every frame advances the script by the same amount, however long it took
+    ENGINE->SetNextTimeStep(BENCH_TIMESTEP);
+}
+
+//Writes every frame to the CSV and the frame time percentiles per phase next to it
+void BenchMaster::WriteResults() const
+{
+    File frameFile{context_, fileName_, FILE_WRITE};
+    if (!frameFile.IsOpen()){
+
+        Log::Write(LOG_ERROR, "Could not write benchmark results to " + fileName_);
+        return;
+    }
+    frameFile.WriteLine("frame,phase,frame_ms,draw_calls,batches,primitives,lights,shadow_maps");
+    for (unsigned f{0}; f < frames_.Size(); ++f){
+
+        const BenchFrame& frame{frames_[f]};
+        frameFile.WriteLine(String(f) + "," + phaseNames_[frame.phase_] + "," + String(frame.frameTime_)
+                            + "," + String(frame.drawCalls_) + "," + String(frame.batches_)
+                            + "," + String(frame.primitives_) + "," + String(frame.lights_)
+                            + "," + String(frame.shadowMaps_));
+    }
+
+    String summaryName{ReplaceExtension(fileName_, "") + "-summary.csv"};
+    File summaryFile{context_, summaryName, FILE_WRITE};
+    if (!summaryFile.IsOpen()){
+
+        Log::Write(LOG_ERROR, "Could not write benchmark summary to " + summaryName);
+        return;
+    }
+    summaryFile.WriteLine("phase,frames,p50_ms,p90_ms,p99_ms,max_ms,mean_draw_calls,mean_batches,mean_lights,mean_shadow_maps");
+    //The warmup only settles shaders and caches, so the totals leave it out
+    for (int p{BP_ORBIT_NEAR}; p <= BP_DONE; ++p){
+
+        PODVector<float> times{};
+        float drawCalls{}, batches{}, lights{}, shadowMaps{};
+        for (const BenchFrame& frame : frames_){
+
+            if (p != BP_DONE ? frame.phase_ != p : frame.phase_ == BP_WARMUP)
+                continue;
+
+            times.Push(frame.frameTime_);
+            drawCalls += frame.drawCalls_;
+            batches += frame.batches_;
+            lights += frame.lights_;
+            shadowMaps += frame.shadowMaps_;
+        }
+        if (times.Empty())
+            continue;
+
+        Sort(times.Begin(), times.End());
+        float count{static_cast<float>(times.Size())};
+        auto percentile = [&times](float fraction){
+            return times[Min(static_cast<unsigned>(fraction * times.Size()), times.Size() - 1)];
+        };
+
+        summaryFile.WriteLine(String(p != BP_DONE ? phaseNames_[p] : "all") + "," + String(times.Size())
+                              + "," + String(percentile(0.5f)) + "," + String(percentile(0.9f))
+                              + "," + String(percentile(0.99f)) + "," + String(times.Back())
+                              + "," + String(drawCalls / count) + "," + String(batches / count)
+                              + "," + String(lights / count) + "," + String(shadowMaps / count));
+    }
+    Log::Write(LOG_INFO, "Benchmark results written to " + fileName_ + " and " + summaryName);
+}
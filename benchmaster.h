@@ -0,0 +1,79 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef BENCHMASTER_H
+#define BENCHMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include <Urho3D/Core/Timer.h>
+
+#include "master.h"
+#include "randomstream.h"
+
+#define BENCH_ARGUMENT "--render-bench"
+#define BENCH_SEED 2305u
+#define BENCH_TIMESTEP (1.0f / 60.0f)
+#define BENCH_WARMUP_TIME 1.0f
+#define BENCH_ORBIT_TIME 6.0f
+#define BENCH_MOVE_TIME 1.23f
+#define BENCH_RESET_TIME (RESET_DURATION + 1.0f)
+
+enum BenchPhase{BP_WARMUP, BP_ORBIT_NEAR, BP_ORBIT_FAR, BP_GAME, BP_RESET, BP_DONE};
+
+//Render statistics of one frame
+struct BenchFrame
+{
+    BenchPhase phase_;
+    float frameTime_;
+    unsigned drawCalls_;
+    unsigned batches_;
+    unsigned primitives_;
+    unsigned lights_;
+    unsigned shadowMaps_;
+};
+
+//Plays the same orbits, game and reset on every run at a fixed timestep,
+//then writes what each frame cost to CSV and quits. Nothing in the script
+//depends on the GPU, so software rasterizers like llvmpipe give comparable runs.
+class BenchMaster : public Master
+{
+    URHO3D_OBJECT(BenchMaster, Master);
+public:
+    BenchMaster(Context* context);
+
+    static bool IsRequested(const Vector<String>& arguments);
+    void Start();
+private:
+    static const char* phaseNames_[BP_DONE];
+
+    String fileName_;
+    RandomStream random_;
+    PODVector<BenchFrame> frames_;
+    HiresTimer frameTimer_;
+    BenchPhase phase_;
+    float phaseTime_;
+    float moveTime_;
+
+    void SetPhase(BenchPhase phase);
+    void PlayMove();
+    void WriteResults() const;
+    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+};
+
+#endif // BENCHMASTER_H
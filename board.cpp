@@ -20,6 +20,7 @@
 #include "piece.h"
 #include "indicator.h"
 #include "effectmaster.h"
+#include "lightmaster.h"
 
 namespace Urho3D {
 template <> unsigned MakeHash(const IntVector2& value)
@@ -47,14 +48,13 @@ void Board::OnNodeSet(Node *node)
     StringVector tag{}; tag.Push(String("Board"));
     node_->SetTags(tag);
     model_ = node_->CreateComponent<StaticModel>();
-    model_->SetModel(MC->GetModel("Board"));
-    model_->SetMaterial(MC->GetMaterial("Board"));
+    model_->SetModel(MC->GetModel(MDL_BOARD));
+    model_->SetMaterial(MC->GetMaterial(MAT_BOARD));
     model_->SetCastShadows(true);
 
     CreateSquares();
     CreateIndicators();
 
-    SubscribeToEvent(E_SCENEUPDATE, URHO3D_HANDLER(Board, HandleSceneUpdate));
 }
 
 void Board::CreateSquares()
@@ -86,18 +86,49 @@ void Board::Reset()
 
         s->free_ = true;
         s->piece_ = nullptr;
-        s->light_->SetEnabled(true);
+        LIGHTS->SetActive(s->light_, true);
 
     }
 
     Deselect();
 }
 
+void Board::GetPosition(Position& position) const
+{
+    for (Square* s: squares_.Values()){
+
+        if (s->piece_){
+            int piece{s->piece_->ToInt()};
+            position.squares_[SquareIndex(s->coords_)] = piece;
+            position.free_ &= ~(1 << piece);
+        }
+    }
+}
+void Board::Restore(const Position& position, bool animate)
+{
+    Deselect();
+    lastSelectedSquare_ = nullptr;
+
+    for (Square* s: squares_.Values()){
+
+        int piece{position.squares_[SquareIndex(s->coords_)]};
+        s->piece_ = piece == NO_PIECE ? nullptr : MC->world_.pieces_[piece].Get();
+        s->free_ = !s->piece_;
+        LIGHTS->SetActive(s->light_, s->free_);
+
+        if (s->piece_)
+            s->piece_->Restore(PieceState::PUT, GetScene(), s->node_->GetWorldPosition(), Quaternion::IDENTITY, animate);
+    }
+
+    if (position.quatter_ >= 0)
+        CheckQuatter();
+}
+
 void Board::Refuse()
 {
     if (selectedSquare_){
-        Material* glow{selectedSquare_->slot_->GetMaterial()};
-        glow->SetShaderParameter("MatDiffColor", Color(1.0f, 0.0f, 0.0f, 1.0f));
+        GlowModel* glow{selectedSquare_->slot_};
+        glow->SetColor(Color(1.0f, 0.0f, 0.0f, 1.0f));
         if (selectedSquare_->free_)
             FX->FadeTo(glow, COLOR_GLOW, 0.23f);
         else
@@ -127,17 +158,6 @@ Vector3 Board::CoordsToPosition(IntVector2 coords)
                    0.5f + coords.y_ - BOARD_HEIGHT / 2);
 }
 
-void Board::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
-{
-    (void)eventType;
-
-    for (Square* s: squares_.Values()){
-
-        s->slot_->SetMorphWeight(0, MC->Sine(2.3f, 0.0f, 1.0f));
-
-    }
-}
-
 bool Board::PutPiece(Piece* piece, Square* square)
 {
     if (!square){
@@ -150,12 +170,12 @@ bool Board::PutPiece(Piece* piece, Square* square)
 
         square->piece_ = piece;
         square->free_ = false;
-        square->light_->SetEnabled(false);
+        LIGHTS->SetActive(square->light_, false);
 
+        float offsetX{MC->GetRandom().Float(-0.05f, 0.05f)};
+        float offsetZ{MC->GetRandom().Float(-0.05f, 0.05f)};
         piece->Put(square->GetNode()->GetWorldPosition()
-                   + Vector3(Random(-0.05f, 0.05f),
-                             0.0f,
-                             Random(-0.05f, 0.05f)));
+                   + Vector3(offsetX, 0.0f, offsetZ));
 
         Deselect();
         lastSelectedSquare_ = nullptr;
@@ -185,6 +205,12 @@ bool Board::PutPiece(){
     return PutPiece(MC->GetPickedPiece());
 }
 
+//Square at the same index as in a Position
+Square* Board::GetSquare(int index) const
+{
+    auto s{squares_.Find(IntVector2(index % BOARD_WIDTH, index / BOARD_WIDTH))};
+    return s != squares_.End() ? s->second_.Get() : nullptr;
+}
 Square* Board::GetNearestSquare(Vector3 pos, bool free)
 {
     Square* nearest{};
@@ -223,10 +249,10 @@ void Board::Select(Square* square)
 
     //Fade in slot and light
     if (square->free_){
-        FX->FadeTo(square->slot_->GetMaterial(),
+        FX->FadeTo(square->slot_,
                    COLOR_GLOW);
     } else {
-        FX->FadeTo(square->slot_->GetMaterial(),
+        FX->FadeTo(square->slot_,
                    Color(1.0f, 0.8f, 0.0f, 0.5f));
     }
 
@@ -240,7 +266,7 @@ void Board::Deselect()
     if (!selectedSquare_) return;
 
     //Fade out slot and light
-    FX->FadeOut(selectedSquare_->slot_->GetMaterial());
+    FX->FadeOut(selectedSquare_->slot_);
     FX->FadeTo(selectedSquare_->light_, 0.023f);
 
     lastSelectedSquare_ = selectedSquare_;
@@ -409,14 +435,12 @@ void Board::Indicate(IntVector2 first, IntVector2 last)
     } else if (first.y_ == last.y_){
         FadeInIndicator(indicators_[0]);
         indicators_[0]->GetNode()->SetPosition(CoordsToPosition(first) * Vector3(0.0f, 1.0f, 1.0f));
-        indicators_[0]->model1_->SetMorphWeight(1, static_cast<float>(first.y_ > 0 && first.y_ < 3));
-        indicators_[0]->model2_->SetMorphWeight(1, static_cast<float>(first.y_ > 0 && first.y_ < 3));
+        indicators_[0]->SetExtended(first.y_ > 0 && first.y_ < 3);
     //Indicate column
     } else if (first.x_ == last.x_){
         FadeInIndicator(indicators_[1]);
         indicators_[1]->GetNode()->SetPosition(CoordsToPosition(first) * Vector3(1.0f, 1.0f, 0.0f));
-        indicators_[1]->model1_->SetMorphWeight(1, static_cast<float>(first.x_ > 0 && first.x_ < 3));
-        indicators_[1]->model2_->SetMorphWeight(1, static_cast<float>(first.x_ > 0 && first.x_ < 3));
+        indicators_[1]->SetExtended(first.x_ > 0 && first.x_ < 3);
     //Indicate first diagonal
     } else if (first.x_ == 0 && last.y_ == 0){
         FadeInIndicator(indicators_[3]);
@@ -432,11 +456,13 @@ void Board::Indicate(IntVector2 first, IntVector2 last)
 }
 void Board::FadeInIndicator(Indicator* indicator)
 {
-    FX->FadeTo(indicator->glow_, COLOR_GLOW, 2.3f, 1.0f);
+    FX->FadeTo(indicator->model1_, COLOR_GLOW, 2.3f, 1.0f);
+    FX->FadeTo(indicator->model2_, COLOR_GLOW, 2.3f, 1.0f);
 }
 void Board::HideIndicators()
 {
     for (SharedPtr<Indicator> i : indicators_){
-        FX->FadeOut(i.Get()->glow_);
+        FX->FadeOut(i->model1_);
+        FX->FadeOut(i->model2_);
     }
 }
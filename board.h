@@ -56,6 +56,7 @@ public:
 
     void Step(IntVector2 step);
     Vector<SharedPtr<Square>> GetSquares() const { return squares_.Values(); }
+    Square* GetSquare(int index) const;
     Square* GetNearestSquare(Vector3 pos, bool free = true);
     Square* GetSelectedSquare() const { return selectedSquare_; }
     Square* GetLastSelectedSquare() const { return lastSelectedSquare_; }
@@ -67,6 +68,10 @@ public:
     void Reset();
     void Refuse();
 
+    static int SquareIndex(IntVector2 coords) { return coords.x_ + BOARD_WIDTH * coords.y_; }
+    void GetPosition(Position& position) const;
+    void Restore(const Position& position, bool animate = false);
+
     bool IsEmpty() const;
     bool IsFull() const;
     void HideIndicators();
@@ -79,7 +84,6 @@ private:
     Square* lastSelectedSquare_;
     Vector<SharedPtr<Indicator>> indicators_;
     Vector3 CoordsToPosition(IntVector2 coords);
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
     void Indicate(IntVector2 first, IntVector2 last = IntVector2(-1, -1));
     void CreateSquares();
     void CreateIndicators();
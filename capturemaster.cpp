@@ -0,0 +1,349 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "capturemaster.h"
+
+#include <Urho3D/Graphics/GraphicsEvents.h>
+#include <Urho3D/IO/Compression.h>
+#include <Urho3D/Resource/Image.h>
+
+#ifdef URHO3D_OPENGL
+#include <GLEW/glew.h>
+#endif
+
+CaptureMaster::CaptureMaster(Context* context) : Master(context),
+    fps_{CAPTURE_FPS},
+    screenshotRequested_{false},
+    recording_{false},
+    numFrames_{0},
+    recordTimer_{},
+    sequence_{},
+    slots_{},
+    nextSlot_{0},
+    queue_{},
+    queueMutex_{},
+    fileMutex_{}
+{
+    const Vector<String>& arguments{GetArguments()};
+    for (unsigned a{0}; a + 1 < arguments.Size(); ++a)
+        if (arguments[a].ToLower() == "-capturefps")
+            fps_ = Max(1.0f, ToFloat(arguments[a + 1]));
+
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(CaptureMaster, HandleBeginFrame));
+    SubscribeToEvent(E_ENDRENDERING, URHO3D_HANDLER(CaptureMaster, HandleEndRendering));
+}
+
+//The frame is read once it has been rendered
+void CaptureMaster::Screenshot()
+{
+    screenshotRequested_ = true;
+}
+//Encodes an image that was rendered elsewhere on a worker
+void CaptureMaster::SavePNG(const Image& image, const String& fileName)
+{
+    Capture capture{CAPTURE_SCREENSHOT, 0, 0.0f, image.GetWidth(), image.GetHeight(), image.GetComponents(), false, {}, fileName};
+    capture.pixels_.Resize(capture.width_ * capture.height_ * capture.components_);
+    memcpy(&capture.pixels_[0], image.GetData(), capture.pixels_.Size());
+    Enqueue(capture);
+}
+void CaptureMaster::ToggleRecording()
+{
+    if (recording_){
+
+        recording_ = false;
+        Flush();
+        {
+            MutexLock lock{fileMutex_};
+            sequence_.Reset();
+        }
+        Log::Write(LOG_INFO, "Recorded " + String(numFrames_) + " frames");
+
+    } else {
+
+        String fileName{NewFileName("Sequence_", ".qcap")};
+        SharedPtr<File> sequence{new File(context_, fileName, FILE_WRITE)};
+        if (!sequence->IsOpen())
+            return;
+
+        sequence->WriteFileID("QCAP");
+        sequence->WriteFloat(fps_);
+        {
+            MutexLock lock{fileMutex_};
+            sequence_ = sequence;
+        }
+
+        recording_ = true;
+        numFrames_ = 0;
+        recordTimer_.Reset();
+        Log::Write(LOG_INFO, "Recording to " + fileName);
+    }
+}
+//Finishes the recording and every capture in flight.
+//Call before the engine exits, that takes the graphics context with it.
+void CaptureMaster::Finish()
+{
+    if (recording_)
+        ToggleRecording();
+    else
+        Flush();
+
+#ifdef URHO3D_OPENGL
+    for (Slot& slot : slots_)
+        if (slot.buffer_){
+
+            glDeleteBuffers(1, &slot.buffer_);
+            slot.buffer_ = 0;
+            slot.size_ = 0;
+        }
+#endif
+}
+//Waits for the workers, the graphics are gone by now
+void CaptureMaster::Stop()
+{
+    GetSubsystem<WorkQueue>()->Complete(M_MAX_UNSIGNED);
+
+    MutexLock lock{fileMutex_};
+    sequence_.Reset();
+}
+void CaptureMaster::Flush()
+{
+    for (Slot& slot : slots_)
+        if (slot.fence_)
+            Collect(slot, true);
+
+    GetSubsystem<WorkQueue>()->Complete(M_MAX_UNSIGNED);
+}
+
+void CaptureMaster::Read(Capture capture)
+{
+    capture.width_ = GRAPHICS->GetWidth();
+    capture.height_ = GRAPHICS->GetHeight();
+
+#ifdef URHO3D_OPENGL
+    if (Graphics::GetGL3Support()){
+
+        //Waiting for the oldest read beats losing a frame
+        Slot& slot{slots_[nextSlot_]};
+        if (slot.fence_)
+            Collect(slot, true);
+        nextSlot_ = (nextSlot_ + 1) % CAPTURE_SLOTS;
+
+        unsigned size{static_cast<unsigned>(capture.width_ * capture.height_ * 4)};
+        if (!slot.buffer_)
+            glGenBuffers(1, &slot.buffer_);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer_);
+        if (slot.size_ != size){
+
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+            slot.size_ = size;
+        }
+
+        //Read the backbuffer without disturbing the framebuffer the engine thinks is bound
+        GLint framebuffer{};
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &framebuffer);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glReadPixels(0, 0, capture.width_, capture.height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        capture.components_ = 4;
+        capture.flipped_ = true;
+        slot.capture_ = capture;
+        slot.fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        return;
+    }
+#endif
+
+    Image image{context_};
+    if (!GRAPHICS->TakeScreenShot(image))
+        return;
+
+    capture.width_ = image.GetWidth();
+    capture.height_ = image.GetHeight();
+    capture.components_ = image.GetComponents();
+    capture.flipped_ = false;
+    capture.pixels_.Resize(capture.width_ * capture.height_ * capture.components_);
+    memcpy(&capture.pixels_[0], image.GetData(), capture.pixels_.Size());
+    Enqueue(capture);
+}
+bool CaptureMaster::Collect(Slot& slot, bool wait)
+{
+#ifdef URHO3D_OPENGL
+    GLsync fence{static_cast<GLsync>(slot.fence_)};
+    GLenum status{};
+    do status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000u : 0u);
+    while (wait && status == GL_TIMEOUT_EXPIRED);
+
+    if (status == GL_TIMEOUT_EXPIRED)
+        return false;
+
+    glDeleteSync(fence);
+    slot.fence_ = nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer_);
+    const void* data{glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.size_, GL_MAP_READ_BIT)};
+    if (data){
+
+        slot.capture_.pixels_.Resize(slot.size_);
+        memcpy(&slot.capture_.pixels_[0], data, slot.size_);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (data)
+        Enqueue(slot.capture_);
+
+    return true;
+#else
+    (void)slot; (void)wait;
+    return true;
+#endif
+}
+//Hands the pixels to a worker, or waits for the workers when they fall behind
+void CaptureMaster::Enqueue(Capture& capture)
+{
+    unsigned queued{};
+    {
+        MutexLock lock{queueMutex_};
+
+        //Swapped, full frames are too big to copy around
+        PODVector<unsigned char> pixels{};
+        pixels.Swap(capture.pixels_);
+        queue_.Push(capture);
+        queue_.Back().pixels_.Swap(pixels);
+        queued = queue_.Size();
+    }
+
+    WorkQueue* workQueue{GetSubsystem<WorkQueue>()};
+    SharedPtr<WorkItem> item{workQueue->GetFreeItem()};
+    item->workFunction_ = EncodeCapture;
+    item->aux_ = this;
+    item->sendEvent_ = false;
+    workQueue->AddWorkItem(item);
+
+    if (queued > CAPTURE_MAX_QUEUED)
+        workQueue->Complete(M_MAX_UNSIGNED);
+}
+void CaptureMaster::EncodeCapture(const WorkItem* item, unsigned threadIndex)
+{ (void)threadIndex;
+
+    static_cast<CaptureMaster*>(item->aux_)->Encode();
+}
+void CaptureMaster::Encode()
+{
+    Capture capture{};
+    {
+        MutexLock lock{queueMutex_};
+
+        if (queue_.Empty())
+            return;
+
+        PODVector<unsigned char> pixels{};
+        pixels.Swap(queue_.Front().pixels_);
+        capture = queue_.Front();
+        capture.pixels_.Swap(pixels);
+        queue_.PopFront();
+    }
+
+    //Tightly packed RGB, top row first
+    PODVector<unsigned char> rgb(capture.width_ * capture.height_ * 3);
+    for (int y{0}; y < capture.height_; ++y){
+
+        int row{capture.flipped_ ? capture.height_ - 1 - y : y};
+        const unsigned char* source{&capture.pixels_[row * capture.width_ * capture.components_]};
+        unsigned char* destination{&rgb[y * capture.width_ * 3]};
+
+        for (int x{0}; x < capture.width_; ++x)
+            for (unsigned c{0}; c < 3; ++c)
+                destination[x * 3 + c] = source[x * capture.components_ + c];
+    }
+
+    if (capture.kind_ == CAPTURE_SCREENSHOT){
+
+        Image image{context_};
+        image.SetSize(capture.width_, capture.height_, 3);
+        image.SetData(&rgb[0]);
+
+        if (capture.fileName_.Empty()){
+
+            String fileName{NewFileName("Screenshot_", ".png")};
+            image.SavePNG(fileName);
+            Log::Write(LOG_INFO, fileName);
+
+        } else {
+
+            image.SavePNG(capture.fileName_);
+        }
+
+    } else {
+
+        PODVector<unsigned char> packed(EstimateCompressBound(rgb.Size()));
+        unsigned packedSize{CompressData(&packed[0], &rgb[0], rgb.Size())};
+
+        MutexLock lock{fileMutex_};
+        if (!sequence_)
+            return;
+
+        sequence_->WriteUInt(capture.frame_);
+        sequence_->WriteFloat(capture.time_);
+        sequence_->WriteInt(capture.width_);
+        sequence_->WriteInt(capture.height_);
+        sequence_->WriteUInt(packedSize);
+        sequence_->Write(&packed[0], packedSize);
+    }
+}
+//In the Screenshots folder with date and time appended
+String CaptureMaster::NewFileName(const String& prefix, const String& extension) const
+{
+    String folder{FILES->GetProgramDir() + "Screenshots/"};
+    FILES->CreateDir(folder);
+
+    return folder + prefix + Time::GetTimeStamp().Replaced(':', '_').Replaced('.', '_').Replaced(' ', '_') + extension;
+}
+
+void CaptureMaster::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    for (unsigned s{0}; s < CAPTURE_SLOTS; ++s){
+
+        Slot& slot{slots_[(nextSlot_ + s) % CAPTURE_SLOTS]};
+        if (slot.fence_ && !Collect(slot, false))
+            break;
+    }
+}
+//The scene is complete here, the user interface is not drawn yet
+void CaptureMaster::HandleEndRendering(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    if (screenshotRequested_){
+
+        screenshotRequested_ = false;
+        Read(Capture{CAPTURE_SCREENSHOT, 0, 0.0f, 0, 0, 0, false, {}, {}});
+    }
+
+    if (recording_){
+
+        float time{recordTimer_.GetUSec(false) * 1e-6f};
+        unsigned frame{static_cast<unsigned>(time * fps_)};
+        if (frame >= numFrames_){
+
+            numFrames_ = frame + 1;
+            Read(Capture{CAPTURE_FRAME, frame, time, 0, 0, 0, false, {}, {}});
+        }
+    }
+}
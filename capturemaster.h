@@ -0,0 +1,107 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef CAPTUREMASTER_H
+#define CAPTUREMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include <Urho3D/Core/Mutex.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/File.h>
+
+#include "master.h"
+
+namespace Urho3D {
+class Image;
+}
+
+#define CAPTURE_SLOTS 3
+#define CAPTURE_FPS 30.0f
+#define CAPTURE_MAX_QUEUED 12
+
+enum CaptureKind{CAPTURE_SCREENSHOT, CAPTURE_FRAME};
+
+struct Capture
+{
+    CaptureKind kind_;
+    unsigned frame_;
+    float time_;
+    int width_;
+    int height_;
+    unsigned components_;
+    bool flipped_;  //Bottom row first, as OpenGL reads them
+    PODVector<unsigned char> pixels_;
+    String fileName_;
+};
+
+//Takes screenshots and records frame sequences without holding up the game.
+//On OpenGL 3 the pixels are copied into pixel buffers that are only mapped
+//once the GPU is done with them, a few frames later. Encoding, to PNG or to
+//LZ4 compressed frames of a sequence, happens on worker threads.
+//
+//A sequence file starts with "QCAP" and the frame rate as a float, followed
+//by records of: frame number, seconds since the start, width, height, size
+//and the compressed RGB pixels, top row first. Records may be out of order
+//and a frame that took longer than one period leaves a gap in the numbers.
+class CaptureMaster : public Master
+{
+    URHO3D_OBJECT(CaptureMaster, Master);
+public:
+    CaptureMaster(Context* context);
+
+    void Screenshot();
+    void SavePNG(const Image& image, const String& fileName);
+    void ToggleRecording();
+    bool IsRecording() const { return recording_; }
+    void Finish();
+    void Stop();
+private:
+    struct Slot
+    {
+        unsigned buffer_;
+        unsigned size_;
+        void* fence_;
+        Capture capture_;
+    };
+
+    float fps_;
+    bool screenshotRequested_;
+    bool recording_;
+    unsigned numFrames_;
+    HiresTimer recordTimer_;
+    SharedPtr<File> sequence_;
+    Slot slots_[CAPTURE_SLOTS];
+    unsigned nextSlot_;
+    List<Capture> queue_;
+    Mutex queueMutex_;
+    Mutex fileMutex_;
+
+    void Read(Capture capture);
+    bool Collect(Slot& slot, bool wait);
+    void Flush();
+    void Enqueue(Capture& capture);
+    static void EncodeCapture(const WorkItem* item, unsigned threadIndex);
+    void Encode();
+    String NewFileName(const String& prefix, const String& extension) const;
+
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    void HandleEndRendering(StringHash eventType, VariantMap& eventData);
+};
+
+#endif // CAPTUREMASTER_H
@@ -0,0 +1,976 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "cook.h"
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Graphics/Geometry.h>
+#include <Urho3D/Graphics/IndexBuffer.h>
+#include <Urho3D/Graphics/VertexBuffer.h>
+#include <Urho3D/IO/Compression.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+static std::vector<unsigned> ReadIndices(Geometry* geometry)
+{
+    IndexBuffer* buffer{geometry->GetIndexBuffer()};
+    const unsigned char* data{buffer->GetShadowData() + geometry->GetIndexStart() * buffer->GetIndexSize()};
+    std::vector<unsigned> indices(geometry->GetIndexCount());
+
+    for (unsigned i{0}; i < indices.size(); ++i)
+        indices[i] = buffer->GetIndexSize() == sizeof(unsigned) ? reinterpret_cast<const unsigned*>(data)[i]
+                                                                : reinterpret_cast<const unsigned short*>(data)[i];
+    return indices;
+}
+static void WriteIndices(Geometry* geometry, const std::vector<unsigned>& indices)
+{
+    IndexBuffer* buffer{geometry->GetIndexBuffer()};
+    unsigned char* data{buffer->GetShadowData() + geometry->GetIndexStart() * buffer->GetIndexSize()};
+
+    for (unsigned i{0}; i < indices.size(); ++i)
+        if (buffer->GetIndexSize() == sizeof(unsigned))
+            reinterpret_cast<unsigned*>(data)[i] = indices[i];
+        else
+            reinterpret_cast<unsigned short*>(data)[i] = static_cast<unsigned short>(indices[i]);
+}
+
+Cook::Cook(Context* context, const CookSettings& settings) : Object(context),
+    settings_{settings},
+    numMissing_{0}
+{
+    settings_.outputDir_ = AddTrailingSlash(settings_.outputDir_);
+    for (String& dir : settings_.resourceDirs_)
+        dir = AddTrailingSlash(dir);
+}
+
+bool Cook::Run()
+{
+    FileSystem* fileSystem{GetSubsystem<FileSystem>()};
+    for (String folder : {"", "Textures", "Models"})
+        if (!fileSystem->CreateDir(settings_.outputDir_ + folder)){
+
+            std::printf("Could not create %s%s\n", settings_.outputDir_.CString(), folder.CString());
+            return false;
+        }
+
+    if (settings_.textures_)
+        CookTextures();
+    if (settings_.models_)
+        CookModels();
+
+    CheckReferences();
+    std::printf("%d missing references\n", numMissing_);
+
+    if (!settings_.package_.Empty() && !WritePackage())
+        return false;
+
+    return !settings_.strict_ || numMissing_ == 0;
+}
+
+void Cook::CookTextures()
+{
+    Vector<String> names{};
+    GetSubsystem<FileSystem>()->ScanDir(names, SourcePath("Textures/"), "*.png", SCAN_FILES, true);
+
+    for (const String& name : names)
+        CookTexture("Textures/" + name);
+}
+bool Cook::CookTexture(const String& name)
+{
+    File file{context_, SourcePath(name)};
+    SharedPtr<Image> image{new Image(context_)};
+    if (!file.IsOpen() || !image->Load(file)){
+
+        std::printf("Could not read %s\n", name.CString());
+        return false;
+    }
+    //Ramps and masks band badly in blocks, and Urho has no single channel block format
+    if (image->GetComponents() < 3){
+
+        std::printf("Kept %s, it has a single channel\n", name.CString());
+        return true;
+    }
+
+    String ddsName{ReplaceExtension(name, ".dds")};
+    bool saved{SaveDDS(image, OutputPath(ddsName))};
+    std::printf("%s %s\n", saved ? "Compressed" : "Could not compress", name.CString());
+
+    return saved;
+}
+//Writes DXT1, or DXT5 when any pixel is translucent, with a full mip chain
+bool Cook::SaveDDS(Image* image, const String& fileName)
+{
+    const int width{image->GetWidth()};
+    const int height{image->GetHeight()};
+    const int components{image->GetComponents()};
+
+    bool alpha{false};
+    if (components == 4)
+        for (int p{0}; p < width * height && !alpha; ++p)
+            alpha = image->GetData()[p * 4 + 3] < 255;
+
+    const unsigned blockSize{alpha ? 16u : 8u};
+    unsigned numLevels{1};
+    for (int size{Max(width, height)}; size > 1; size /= 2)
+        ++numLevels;
+
+    File file{context_, fileName, FILE_WRITE};
+    if (!file.IsOpen())
+        return false;
+
+    file.WriteFileID("DDS ");
+    file.WriteUInt(124);                                        //Header size
+    file.WriteUInt(0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000); //Caps, height, width, pixel format, mipmaps, linear size
+    file.WriteUInt(height);
+    file.WriteUInt(width);
+    file.WriteUInt(((width + 3) / 4) * ((height + 3) / 4) * blockSize);
+    file.WriteUInt(0);                                          //Depth
+    file.WriteUInt(numLevels);
+    for (int r{0}; r < 11; ++r)
+        file.WriteUInt(0);
+
+    file.WriteUInt(32);                                         //Pixel format size
+    file.WriteUInt(0x4);                                        //Four character code
+    file.WriteFileID(alpha ? "DXT5" : "DXT1");
+    for (int r{0}; r < 5; ++r)
+        file.WriteUInt(0);
+
+    file.WriteUInt(0x1000 | (numLevels > 1 ? 0x8 | 0x400000 : 0)); //Texture, complex, mipmap
+    for (int r{0}; r < 4; ++r)
+        file.WriteUInt(0);
+
+    SharedPtr<Image> level{image};
+    for (unsigned l{0}; l < numLevels && level; ++l){
+
+        const int levelWidth{level->GetWidth()};
+        const int levelHeight{level->GetHeight()};
+        const unsigned char* data{level->GetData()};
+
+        for (int by{0}; by < levelHeight; by += 4)
+            for (int bx{0}; bx < levelWidth; bx += 4){
+
+                //Edge blocks repeat their last row and column
+                unsigned char rgba[64];
+                for (int p{0}; p < 16; ++p){
+
+                    int x{Min(bx + p % 4, levelWidth - 1)};
+                    int y{Min(by + p / 4, levelHeight - 1)};
+                    const unsigned char* pixel{data + (y * levelWidth + x) * components};
+
+                    for (int c{0}; c < 3; ++c)
+                        rgba[p * 4 + c] = pixel[c];
+                    rgba[p * 4 + 3] = components == 4 ? pixel[3] : 255;
+                }
+
+                unsigned char block[16];
+                CompressBlock(rgba, alpha, block);
+                file.Write(block, blockSize);
+            }
+
+        if (l + 1 < numLevels)
+            level = level->GetNextLevel();
+    }
+
+    return true;
+}
+
+static unsigned short Pack565(const int* rgb)
+{
+    return static_cast<unsigned short>(((rgb[0] * 31 + 127) / 255) << 11
+                                     | ((rgb[1] * 63 + 127) / 255) << 5
+                                     | ((rgb[2] * 31 + 127) / 255));
+}
+static void Unpack565(unsigned short packed, int* rgb)
+{
+    int r{packed >> 11};
+    int g{(packed >> 5) & 0x3f};
+    int b{packed & 0x1f};
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+//Bounding box endpoints, inset a little and turned along the colour correlation
+void Cook::CompressBlock(const unsigned char* rgba, bool alpha, unsigned char* block)
+{
+    if (alpha){
+
+        int high{0};
+        int low{255};
+        for (int p{0}; p < 16; ++p){
+            high = Max(high, static_cast<int>(rgba[p * 4 + 3]));
+            low = Min(low, static_cast<int>(rgba[p * 4 + 3]));
+        }
+
+        int palette[8]{high, low};
+        for (int i{2}; i < 8; ++i)
+            palette[i] = ((8 - i) * high + (i - 1) * low) / 7;
+
+        unsigned long long bits{0};
+        if (high != low)
+            for (int p{0}; p < 16; ++p){
+
+                int best{0};
+                for (int i{1}; i < 8; ++i)
+                    if (Abs(palette[i] - rgba[p * 4 + 3]) < Abs(palette[best] - rgba[p * 4 + 3]))
+                        best = i;
+
+                bits |= static_cast<unsigned long long>(best) << (3 * p);
+            }
+
+        block[0] = static_cast<unsigned char>(high);
+        block[1] = static_cast<unsigned char>(low);
+        for (int b{0}; b < 6; ++b)
+            block[2 + b] = static_cast<unsigned char>(bits >> (8 * b));
+
+        block += 8;
+    }
+
+    int low[3]{255, 255, 255};
+    int high[3]{0, 0, 0};
+    float mean[3]{};
+    for (int p{0}; p < 16; ++p)
+        for (int c{0}; c < 3; ++c){
+            low[c] = Min(low[c], static_cast<int>(rgba[p * 4 + c]));
+            high[c] = Max(high[c], static_cast<int>(rgba[p * 4 + c]));
+            mean[c] += rgba[p * 4 + c] / 16.0f;
+        }
+
+    float covariance[3]{};
+    for (int p{0}; p < 16; ++p)
+        for (int c : {0, 2})
+            covariance[c] += (rgba[p * 4 + c] - mean[c]) * (rgba[p * 4 + 1] - mean[1]);
+
+    for (int c{0}; c < 3; ++c){
+
+        int inset{(high[c] - low[c]) >> 4};
+        low[c] += inset;
+        high[c] -= inset;
+
+        if (covariance[c] < 0.0f)
+            std::swap(low[c], high[c]);
+    }
+
+    unsigned short color0{Pack565(high)};
+    unsigned short color1{Pack565(low)};
+    //The first colour has to be the larger one for four colour blocks
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    int palette[4][3];
+    Unpack565(color0, palette[0]);
+    Unpack565(color1, palette[1]);
+    for (int c{0}; c < 3; ++c){
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    unsigned bits{0};
+    if (color0 != color1)
+        for (int p{0}; p < 16; ++p){
+
+            int best{0};
+            int bestDistance{M_MAX_INT};
+            for (int i{0}; i < 4; ++i){
+
+                int distance{0};
+                for (int c{0}; c < 3; ++c)
+                    distance += (palette[i][c] - rgba[p * 4 + c]) * (palette[i][c] - rgba[p * 4 + c]);
+
+                if (distance < bestDistance){
+                    best = i;
+                    bestDistance = distance;
+                }
+            }
+            bits |= best << (2 * p);
+        }
+
+    block[0] = static_cast<unsigned char>(color0);
+    block[1] = static_cast<unsigned char>(color0 >> 8);
+    block[2] = static_cast<unsigned char>(color1);
+    block[3] = static_cast<unsigned char>(color1 >> 8);
+    for (int b{0}; b < 4; ++b)
+        block[4 + b] = static_cast<unsigned char>(bits >> (8 * b));
+}
+
+void Cook::CookModels()
+{
+    Vector<String> names{};
+    GetSubsystem<FileSystem>()->ScanDir(names, SourcePath("Models/"), "*.mdl", SCAN_FILES, true);
+
+    for (const String& name : names)
+        CookModel("Models/" + name);
+}
+bool Cook::CookModel(const String& name)
+{
+    File file{context_, SourcePath(name)};
+    SharedPtr<Model> model{new Model(context_)};
+    model->SetName(name);
+    if (!file.IsOpen() || !model->Load(file)){
+
+        std::printf("Could not read %s\n", name.CString());
+        return false;
+    }
+
+    for (unsigned g{0}; g < model->GetNumGeometries(); ++g)
+        for (unsigned l{0}; l < model->GetNumGeometryLodLevels(g); ++l){
+
+            Geometry* geometry{model->GetGeometry(g, l)};
+            if (geometry->GetPrimitiveType() != TRIANGLE_LIST || !geometry->GetIndexBuffer())
+                continue;
+
+            std::vector<unsigned> indices{ReadIndices(geometry)};
+            OptimizeVertexCache(indices, geometry->GetVertexBuffer(0)->GetVertexCount());
+            WriteIndices(geometry, indices);
+        }
+
+    GenerateLods(model);
+
+    File output{context_, OutputPath(name), FILE_WRITE};
+    bool saved{output.IsOpen() && model->Save(output)};
+    std::printf("%s %s\n", saved ? "Optimized" : "Could not optimize", name.CString());
+
+    return saved;
+}
+//Adds halved detail levels to models that don't have any yet
+void Cook::GenerateLods(Model* model)
+{
+    unsigned numTriangles{0};
+    for (unsigned g{0}; g < model->GetNumGeometries(); ++g)
+        numTriangles += model->GetGeometry(g, 0)->GetIndexCount() / 3;
+
+    if (numTriangles < LOD_MIN_TRIANGLES)
+        return;
+
+    struct Lod
+    {
+        unsigned geometry_;
+        unsigned level_;
+        unsigned start_;
+        unsigned count_;
+    };
+    std::vector<Lod> lods{};
+    std::vector<unsigned> lodIndices{};
+    unsigned maxIndex{0};
+
+    for (unsigned g{0}; g < model->GetNumGeometries(); ++g){
+
+        Geometry* base{model->GetGeometry(g, 0)};
+        VertexBuffer* vertices{base->GetVertexBuffer(0)};
+        if (model->GetNumGeometryLodLevels(g) > 1
+         || base->GetPrimitiveType() != TRIANGLE_LIST
+         || !base->GetIndexBuffer()
+         || vertices->GetElementOffset(SEM_POSITION) == M_MAX_UNSIGNED)
+            continue;
+
+        std::vector<Vector3> positions(vertices->GetVertexCount());
+        const unsigned char* data{vertices->GetShadowData() + vertices->GetElementOffset(SEM_POSITION)};
+        for (unsigned v{0}; v < positions.size(); ++v)
+            std::memcpy(&positions[v], data + v * vertices->GetVertexSize(), sizeof(Vector3));
+
+        std::vector<unsigned> previous{ReadIndices(base)};
+        for (unsigned l{1}; l < LOD_LEVELS; ++l){
+
+            std::vector<unsigned> simplified{Simplify(previous, positions, previous.size() / 6)};
+            //Not worth a level of its own
+            if (simplified.size() * 5 > previous.size() * 4)
+                break;
+
+            OptimizeVertexCache(simplified, positions.size());
+            lods.push_back(Lod{g, l, static_cast<unsigned>(lodIndices.size()), static_cast<unsigned>(simplified.size())});
+            lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.end());
+            maxIndex = Max(maxIndex, vertices->GetVertexCount() - 1);
+
+            previous = simplified;
+        }
+    }
+
+    if (lods.empty())
+        return;
+
+    bool large{maxIndex > 0xffff};
+    SharedPtr<IndexBuffer> buffer{new IndexBuffer(context_)};
+    buffer->SetShadowed(true);
+    buffer->SetSize(static_cast<unsigned>(lodIndices.size()), large);
+    if (large){
+
+        buffer->SetData(lodIndices.data());
+
+    } else {
+
+        std::vector<unsigned short> shortIndices(lodIndices.begin(), lodIndices.end());
+        buffer->SetData(shortIndices.data());
+    }
+
+    Vector<SharedPtr<IndexBuffer> > buffers{model->GetIndexBuffers()};
+    buffers.Push(buffer);
+    model->SetIndexBuffers(buffers);
+
+    for (const Lod& lod : lods){
+
+        Geometry* base{model->GetGeometry(lod.geometry_, 0)};
+        if (model->GetNumGeometryLodLevels(lod.geometry_) <= lod.level_)
+            model->SetNumGeometryLodLevels(lod.geometry_, lod.level_ + 1);
+
+        SharedPtr<Geometry> geometry{new Geometry(context_)};
+        geometry->SetNumVertexBuffers(base->GetNumVertexBuffers());
+        for (unsigned v{0}; v < base->GetNumVertexBuffers(); ++v)
+            geometry->SetVertexBuffer(v, base->GetVertexBuffer(v));
+        geometry->SetIndexBuffer(buffer);
+        geometry->SetDrawRange(TRIANGLE_LIST, lod.start_, lod.count_);
+        geometry->SetLodDistance(LOD_DISTANCE * lod.level_);
+
+        model->SetGeometry(lod.geometry_, lod.level_, geometry);
+    }
+}
+
+//Tom Forsyth's linear-speed vertex cache optimisation
+void Cook::OptimizeVertexCache(std::vector<unsigned>& indices, unsigned numVertices)
+{
+    const unsigned numTriangles{static_cast<unsigned>(indices.size() / 3)};
+    if (numTriangles < 2)
+        return;
+
+    std::vector<unsigned> remaining(numVertices, 0);
+    for (unsigned index : indices)
+        ++remaining[index];
+
+    std::vector<unsigned> firstTriangle(numVertices + 1, 0);
+    for (unsigned v{0}; v < numVertices; ++v)
+        firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+
+    std::vector<unsigned> vertexTriangles(indices.size());
+    std::vector<unsigned> filled(firstTriangle.begin(), firstTriangle.end() - 1);
+    for (unsigned i{0}; i < indices.size(); ++i)
+        vertexTriangles[filled[indices[i]]++] = i / 3;
+
+    std::vector<int> cachePosition(numVertices, -1);
+    std::vector<float> vertexScore(numVertices, 0.0f);
+    auto scoreVertex = [&](unsigned v){
+
+        if (remaining[v] == 0)
+            return -1.0f;
+
+        float score{0.0f};
+        int position{cachePosition[v]};
+        if (position >= 0)
+            score = position < 3 ? 0.75f
+                                 : std::pow(1.0f - (position - 3) / static_cast<float>(VERTEX_CACHE_SIZE - 3), 1.5f);
+
+        return score + 2.0f / std::sqrt(static_cast<float>(remaining[v]));
+    };
+    for (unsigned v{0}; v < numVertices; ++v)
+        vertexScore[v] = scoreVertex(v);
+
+    std::vector<float> triangleScore(numTriangles);
+    std::vector<bool> emitted(numTriangles, false);
+    int best{0};
+    for (unsigned t{0}; t < numTriangles; ++t){
+
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+        if (triangleScore[t] > triangleScore[best])
+            best = t;
+    }
+
+    std::vector<unsigned> result{};
+    result.reserve(indices.size());
+    std::vector<unsigned> cache{};
+    unsigned nextUnemitted{0};
+
+    while (result.size() < indices.size()){
+
+        //Nothing in the cache connects to anything left, start over elsewhere
+        if (best < 0){
+
+            while (emitted[nextUnemitted])
+                ++nextUnemitted;
+            best = nextUnemitted;
+        }
+
+        emitted[best] = true;
+        std::vector<unsigned> newCache{};
+        for (int c{0}; c < 3; ++c){
+
+            unsigned v{indices[best * 3 + c]};
+            result.push_back(v);
+            --remaining[v];
+            newCache.push_back(v);
+        }
+        for (unsigned v : cache)
+            if (std::find(newCache.begin(), newCache.end(), v) == newCache.end())
+                newCache.push_back(v);
+
+        for (unsigned c{0}; c < newCache.size(); ++c){
+
+            unsigned v{newCache[c]};
+            cachePosition[v] = c < VERTEX_CACHE_SIZE ? static_cast<int>(c) : -1;
+            vertexScore[v] = scoreVertex(v);
+        }
+
+        best = -1;
+        float bestScore{-1.0f};
+        for (unsigned v : newCache)
+            for (unsigned i{firstTriangle[v]}; i < firstTriangle[v + 1]; ++i){
+
+                unsigned t{vertexTriangles[i]};
+                if (emitted[t])
+                    continue;
+
+                triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                if (triangleScore[t] > bestScore){
+                    best = t;
+                    bestScore = triangleScore[t];
+                }
+            }
+
+        if (newCache.size() > VERTEX_CACHE_SIZE)
+            newCache.resize(VERTEX_CACHE_SIZE);
+        cache.swap(newCache);
+    }
+
+    indices.swap(result);
+}
+
+//Quadric error edge collapse onto existing vertices, so the vertex buffer can be shared.
+//Seams and borders stay put to keep texture coordinates and silhouettes intact.
+std::vector<unsigned> Cook::Simplify(const std::vector<unsigned>& indices,
+                                     const std::vector<Vector3>& positions,
+                                     unsigned targetTriangles)
+{
+    const unsigned numVertices{static_cast<unsigned>(positions.size())};
+
+    std::vector<bool> locked(numVertices, false);
+    std::map<std::tuple<float, float, float>, unsigned> welded{};
+    for (unsigned v{0}; v < numVertices; ++v){
+
+        auto key{std::make_tuple(positions[v].x_, positions[v].y_, positions[v].z_)};
+        auto found{welded.find(key)};
+        if (found == welded.end())
+            welded[key] = v;
+        else
+            locked[v] = locked[found->second] = true;
+    }
+
+    std::map<std::pair<unsigned, unsigned>, int> edgeUse{};
+    for (unsigned i{0}; i < indices.size(); i += 3)
+        for (int e{0}; e < 3; ++e){
+
+            unsigned a{indices[i + e]};
+            unsigned b{indices[i + (e + 1) % 3]};
+            ++edgeUse[std::make_pair(Min(a, b), Max(a, b))];
+        }
+    for (auto& edge : edgeUse)
+        if (edge.second == 1)
+            locked[edge.first.first] = locked[edge.first.second] = true;
+
+    //Symmetric plane quadrics: xx xy xz xw yy yz yw zz zw ww
+    std::vector<std::array<double, 10> > quadrics(numVertices, std::array<double, 10>{});
+    for (unsigned i{0}; i < indices.size(); i += 3){
+
+        const Vector3& p0{positions[indices[i]]};
+        Vector3 normal{(positions[indices[i + 1]] - p0).CrossProduct(positions[indices[i + 2]] - p0)};
+        double area{normal.Length() * 0.5};
+        if (area <= 0.0)
+            continue;
+
+        normal.Normalize();
+        double plane[4]{normal.x_, normal.y_, normal.z_, -normal.DotProduct(p0)};
+        std::array<double, 10> quadric{};
+        int q{0};
+        for (int r{0}; r < 4; ++r)
+            for (int c{r}; c < 4; ++c)
+                quadric[q++] = area * plane[r] * plane[c];
+
+        for (int c{0}; c < 3; ++c)
+            for (int k{0}; k < 10; ++k)
+                quadrics[indices[i + c]][k] += quadric[k];
+    }
+    auto error = [](const std::array<double, 10>& q, const Vector3& p){
+
+        double x{p.x_}, y{p.y_}, z{p.z_};
+        return q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x
+             + q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y
+             + q[7] * z * z + 2.0 * q[8] * z
+             + q[9];
+    };
+
+    std::vector<unsigned> result{indices};
+    for (int pass{0}; pass < 64 && result.size() / 3 > targetTriangles; ++pass){
+
+        struct Collapse
+        {
+            unsigned from_;
+            unsigned to_;
+            double cost_;
+        };
+        std::vector<Collapse> collapses{};
+        for (unsigned i{0}; i < result.size(); i += 3)
+            for (int e{0}; e < 3; ++e){
+
+                unsigned a{result[i + e]};
+                unsigned b{result[i + (e + 1) % 3]};
+                if (!locked[a])
+                    collapses.push_back(Collapse{a, b, error(quadrics[a], positions[b])});
+                if (!locked[b])
+                    collapses.push_back(Collapse{b, a, error(quadrics[b], positions[a])});
+            }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& lhs, const Collapse& rhs){ return lhs.cost_ < rhs.cost_; });
+
+        std::vector<std::vector<unsigned> > vertexTriangles(numVertices);
+        for (unsigned i{0}; i < result.size(); i += 3)
+            for (int c{0}; c < 3; ++c)
+                vertexTriangles[result[i + c]].push_back(i);
+
+        std::vector<unsigned> remap(numVertices);
+        for (unsigned v{0}; v < numVertices; ++v)
+            remap[v] = v;
+
+        std::vector<bool> touched(numVertices, false);
+        unsigned removable{static_cast<unsigned>(result.size() / 3) - targetTriangles};
+        unsigned removed{0};
+
+        for (const Collapse& collapse : collapses){
+
+            if (removed >= removable)
+                break;
+            if (touched[collapse.from_] || touched[collapse.to_])
+                continue;
+
+            //Refuse collapses that fold triangles over
+            bool flips{false};
+            unsigned vanishing{0};
+            for (unsigned t : vertexTriangles[collapse.from_]){
+
+                unsigned corners[3]{result[t], result[t + 1], result[t + 2]};
+                if (corners[0] == collapse.to_ || corners[1] == collapse.to_ || corners[2] == collapse.to_){
+                    ++vanishing;
+                    continue;
+                }
+
+                Vector3 before{(positions[corners[1]] - positions[corners[0]]).CrossProduct(positions[corners[2]] - positions[corners[0]])};
+                for (unsigned& corner : corners)
+                    if (corner == collapse.from_)
+                        corner = collapse.to_;
+                Vector3 after{(positions[corners[1]] - positions[corners[0]]).CrossProduct(positions[corners[2]] - positions[corners[0]])};
+
+                if (before.DotProduct(after) < 0.25f * before.Length() * after.Length()){
+                    flips = true;
+                    break;
+                }
+            }
+            if (flips)
+                continue;
+
+            remap[collapse.from_] = collapse.to_;
+            for (int k{0}; k < 10; ++k)
+                quadrics[collapse.to_][k] += quadrics[collapse.from_][k];
+
+            for (unsigned v : {collapse.from_, collapse.to_})
+                for (unsigned t : vertexTriangles[v])
+                    for (int c{0}; c < 3; ++c)
+                        touched[result[t + c]] = true;
+
+            removed += vanishing;
+        }
+
+        if (!removed)
+            break;
+
+        std::vector<unsigned> collapsed{};
+        for (unsigned i{0}; i < result.size(); i += 3){
+
+            unsigned a{remap[result[i]]};
+            unsigned b{remap[result[i + 1]]};
+            unsigned c{remap[result[i + 2]]};
+            if (a != b && b != c && c != a){
+                collapsed.push_back(a);
+                collapsed.push_back(b);
+                collapsed.push_back(c);
+            }
+        }
+        result.swap(collapsed);
+    }
+
+    return result;
+}
+
+//Writes the LZ4 flavour of Urho3D's PackageFile. Files are found the way the
+//game finds them in its resource paths: cooked first, then the folders in order.
+bool Cook::WritePackage()
+{
+    FileSystem* fileSystem{GetSubsystem<FileSystem>()};
+    std::map<String, String> sources{};
+
+    Vector<String> dirs{settings_.resourceDirs_};
+    dirs.Insert(0, settings_.outputDir_);
+    for (const String& dir : dirs){
+
+        //The cooked folder usually lives inside the resources
+        String nested{};
+        if (dir != settings_.outputDir_ && settings_.outputDir_.StartsWith(dir))
+            nested = settings_.outputDir_.Substring(dir.Length());
+
+        Vector<String> names{};
+        fileSystem->ScanDir(names, dir, "*", SCAN_FILES, true);
+
+        for (const String& name : names)
+            if ((nested.Empty() || !name.StartsWith(nested)) && GetExtension(name) != ".pak")
+                sources.insert({name, dir + name});
+    }
+
+    File package{context_, settings_.package_, FILE_WRITE};
+    if (!package.IsOpen()){
+
+        std::printf("Could not write %s\n", settings_.package_.CString());
+        return false;
+    }
+
+    //Offsets and checksums are filled in once the data is written
+    package.WriteFileID("ULZ4");
+    package.WriteUInt(static_cast<unsigned>(sources.size()));
+    package.WriteUInt(0);
+    unsigned entriesStart{package.GetPosition()};
+    for (const auto& source : sources){
+
+        package.WriteString(source.first);
+        package.WriteUInt(0);
+        package.WriteUInt(0);
+        package.WriteUInt(0);
+    }
+
+    struct Entry { unsigned offset_; unsigned size_; unsigned checksum_; };
+    std::vector<Entry> entries{};
+    std::vector<unsigned char> data{};
+    std::vector<unsigned char> packed(EstimateCompressBound(PACKAGE_BLOCK_SIZE));
+    unsigned checksum{0};
+    unsigned totalSize{0};
+
+    for (const auto& source : sources){
+
+        File file{context_, source.second};
+        if (!file.IsOpen()){
+
+            std::printf("Could not read %s\n", source.second.CString());
+            return false;
+        }
+        data.resize(file.GetSize());
+        if (!data.empty())
+            file.Read(&data[0], file.GetSize());
+
+        Entry entry{package.GetPosition(), static_cast<unsigned>(data.size()), 0};
+        for (unsigned char byte : data){
+
+            checksum = SDBMHash(checksum, byte);
+            entry.checksum_ = SDBMHash(entry.checksum_, byte);
+        }
+        entries.push_back(entry);
+        totalSize += entry.size_;
+
+        for (unsigned position{0}; position < data.size(); position += PACKAGE_BLOCK_SIZE){
+
+            unsigned blockSize{Min(static_cast<unsigned>(data.size()) - position, static_cast<unsigned>(PACKAGE_BLOCK_SIZE))};
+            unsigned packedSize{CompressData(&packed[0], &data[position], blockSize)};
+            if (!packedSize){
+
+                std::printf("Could not compress %s\n", source.first.CString());
+                return false;
+            }
+            package.WriteUShort(static_cast<unsigned short>(blockSize));
+            package.WriteUShort(static_cast<unsigned short>(packedSize));
+            package.Write(&packed[0], packedSize);
+        }
+    }
+    //Lets PackageFile find the package when it is appended to an executable
+    package.WriteUInt(package.GetSize() + sizeof(unsigned));
+
+    package.Seek(entriesStart - sizeof(unsigned));
+    package.WriteUInt(checksum);
+    unsigned e{0};
+    for (const auto& source : sources){
+
+        const Entry& entry{entries[e++]};
+        package.WriteString(source.first);
+        package.WriteUInt(entry.offset_);
+        package.WriteUInt(entry.size_);
+        package.WriteUInt(entry.checksum_);
+    }
+
+    std::printf("Packed %u files, %u bytes into %u\n", static_cast<unsigned>(sources.size()), totalSize, package.GetSize());
+    return true;
+}
+
+void Cook::CheckReferences()
+{
+    FileSystem* fileSystem{GetSubsystem<FileSystem>()};
+
+    for (String folder : {"Materials/", "Techniques/", "Textures/", "RenderPaths/", "PostProcess/"}){
+
+        Vector<String> names{};
+        fileSystem->ScanDir(names, SourcePath(folder), "*.xml", SCAN_FILES, true);
+
+        for (const String& name : names){
+
+            if (folder == "Materials/")
+                CheckMaterial(folder + name);
+            else if (folder == "Textures/")
+                CheckTextureXML(folder + name);
+            else
+                CheckTechnique(folder + name);
+        }
+    }
+}
+void Cook::CheckMaterial(const String& name)
+{
+    File file{context_, SourcePath(name)};
+    XMLFile xml{context_};
+    if (!file.IsOpen() || !xml.Load(file))
+        return;
+
+    XMLElement root{xml.GetRoot()};
+    for (XMLElement technique{root.GetChild("technique")}; technique; technique = technique.GetNext("technique"))
+        Require(technique.GetAttribute("name"), name);
+    for (XMLElement texture{root.GetChild("texture")}; texture; texture = texture.GetNext("texture"))
+        Require(texture.GetAttribute("name"), name);
+}
+//Techniques, render paths and post-processes all name their shaders through vs and ps
+void Cook::CheckTechnique(const String& name)
+{
+    File file{context_, SourcePath(name)};
+    XMLFile xml{context_};
+    if (!file.IsOpen() || !xml.Load(file))
+        return;
+
+    XMLElement root{xml.GetRoot()};
+    Vector<XMLElement> elements{};
+    elements.Push(root);
+    for (String child : {"pass", "command"})
+        for (XMLElement element{root.GetChild(child)}; element; element = element.GetNext(child))
+            elements.Push(element);
+
+    for (const XMLElement& element : elements)
+        for (String attribute : {"vs", "ps"}){
+
+            String shader{element.GetAttribute(attribute)};
+            if (shader.Empty())
+                continue;
+
+            Require("Shaders/GLSL/" + shader + ".glsl", name);
+            Require("Shaders/HLSL/" + shader + ".hlsl", name);
+        }
+}
+void Cook::CheckTextureXML(const String& name)
+{
+    File file{context_, SourcePath(name)};
+    XMLFile xml{context_};
+    if (!file.IsOpen() || !xml.Load(file))
+        return;
+
+    //Names without a path are relative to the XML file
+    XMLElement root{xml.GetRoot()};
+    for (String child : {"face", "image"})
+        for (XMLElement element{root.GetChild(child)}; element; element = element.GetNext(child)){
+
+            String texture{element.GetAttribute("name")};
+            if (GetPath(texture).Empty())
+                texture = GetPath(name) + texture;
+
+            Require(texture, name);
+        }
+}
+void Cook::Require(const String& name, const String& referrer)
+{
+    if (name.Empty() || Exists(name))
+        return;
+
+    std::printf("Missing %s, referenced by %s\n", name.CString(), referrer.CString());
+    ++numMissing_;
+}
+bool Cook::Exists(const String& name) const
+{
+    FileSystem* fileSystem{GetSubsystem<FileSystem>()};
+    for (const String& dir : settings_.resourceDirs_)
+        if (fileSystem->FileExists(dir + name))
+            return true;
+
+    return false;
+}
+
+static void PrintUsage()
+{
+    std::printf("Usage: quatter-cook [options] resources [data...]\n"
+                "Cooks the first resource folder, all of them are searched for references.\n"
+                "Options:\n"
+                "  -o DIR           Output folder (Resources/Cooked)\n"
+                "  -notextures      Leave textures alone\n"
+                "  -nomodels        Leave models alone\n"
+                "  -strict          Fail when references are missing\n"
+                "  -pack FILE       Also write everything to one compressed package\n");
+}
+
+int main(int argc, char** argv)
+{
+    CookSettings settings{"Resources/Cooked", {}, true, true, false, {}};
+
+    for (int a{1}; a < argc; ++a){
+
+        String argument{argv[a]};
+
+        if (argument == "-o" && a + 1 < argc)
+            settings.outputDir_ = argv[++a];
+        else if (argument == "-notextures")
+            settings.textures_ = false;
+        else if (argument == "-nomodels")
+            settings.models_ = false;
+        else if (argument == "-strict")
+            settings.strict_ = true;
+        else if (argument == "-pack" && a + 1 < argc)
+            settings.package_ = argv[++a];
+        else if (argument[0] == '-'){
+            PrintUsage();
+            return 1;
+        } else
+            settings.resourceDirs_.Push(argument);
+    }
+
+    if (settings.resourceDirs_.Empty()){
+        PrintUsage();
+        return 1;
+    }
+
+    SharedPtr<Context> context{new Context()};
+    context->RegisterSubsystem(new FileSystem(context));
+    //Models look for metadata next to them through the cache
+    RegisterResourceLibrary(context);
+    ResourceCache* cache{new ResourceCache(context)};
+    context->RegisterSubsystem(cache);
+    for (const String& dir : settings.resourceDirs_)
+        cache->AddResourceDir(dir);
+
+    SharedPtr<Cook> cook{new Cook(context, settings)};
+    return cook->Run() ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef COOK_H
+#define COOK_H
+
+#include <Urho3D/Urho3D.h>
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Resource/Image.h>
+
+#include <vector>
+
+using namespace Urho3D;
+
+//Models with fewer triangles than this are not worth extra detail levels
+#define LOD_MIN_TRIANGLES 256
+#define LOD_LEVELS 3
+#define LOD_DISTANCE 12.0f
+#define VERTEX_CACHE_SIZE 32
+//Largest block PackageFile can decompress, its sizes are stored as shorts
+#define PACKAGE_BLOCK_SIZE 32768
+
+struct CookSettings
+{
+    String outputDir_;
+    Vector<String> resourceDirs_;  //The first one is cooked, all are searched for references
+    bool textures_;
+    bool models_;
+    bool strict_;
+    String package_;  //Archive for everything, cooked resources first
+};
+
+//Prepares resources for the GPU ahead of time: block-compressed textures with
+//their mipmaps, detail levels and vertex cache friendly triangle orders, and
+//a report of every resource that is referenced but can't be found. Optionally
+//all of it ends up in a single compressed package.
+class Cook : public Object
+{
+    URHO3D_OBJECT(Cook, Object);
+public:
+    Cook(Context* context, const CookSettings& settings);
+    bool Run();
+
+    static void CompressBlock(const unsigned char* rgba, bool alpha, unsigned char* block);
+    static void OptimizeVertexCache(std::vector<unsigned>& indices, unsigned numVertices);
+    static std::vector<unsigned> Simplify(const std::vector<unsigned>& indices,
+                                          const std::vector<Vector3>& positions,
+                                          unsigned targetTriangles);
+private:
+    CookSettings settings_;
+    int numMissing_;
+
+    void CookTextures();
+    bool CookTexture(const String& name);
+    bool SaveDDS(Image* image, const String& fileName);
+    void CookModels();
+    bool CookModel(const String& name);
+    void GenerateLods(Model* model);
+
+    bool WritePackage();
+
+    void CheckReferences();
+    void CheckMaterial(const String& name);
+    void CheckTechnique(const String& name);
+    void CheckTextureXML(const String& name);
+    void Require(const String& name, const String& referrer);
+    bool Exists(const String& name) const;
+    String SourcePath(const String& name) const { return settings_.resourceDirs_.Front() + name; }
+    String OutputPath(const String& name) const { return settings_.outputDir_ + name; }
+};
+
+#endif // COOK_H
@@ -0,0 +1,36 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef COOKEDROUTER_H
+#define COOKEDROUTER_H
+
+#include <Urho3D/Urho3D.h>
+#include <Urho3D/Resource/ResourceCache.h>
+
+using namespace Urho3D;
+
+//Serves the block-compressed twin that quatter-cook made of a PNG texture
+class CookedRouter : public ResourceRouter
+{
+    URHO3D_OBJECT(CookedRouter, ResourceRouter);
+public:
+    CookedRouter(Context* context);
+    virtual void Route(String& name, ResourceRequest requestType);
+};
+
+#endif // COOKEDROUTER_H
@@ -0,0 +1,85 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "ecomaster.h"
+#include "effectmaster.h"
+#include "capturemaster.h"
+#include "inputmaster.h"
+#include "quattercam.h"
+
+EcoMaster::EcoMaster(Context* context) : Master(context),
+    level_{ECO_AWAKE},
+    enabled_{true},
+    awakeFps_{GetSubsystem<Engine>()->GetMaxFps()}
+{
+    for (const String& argument : GetArguments())
+        if (argument.ToLower() == "-noeco")
+            enabled_ = false;
+
+    //Benchmarks measure and replays record every frame at full speed.
+    //Sleeping would pause the scene, so input sessions keep it awake too.
+    if (MC->IsBenchmark() || MC->IsReplay() || MC->IsRecordingInput() || MC->IsPlayingInput())
+        enabled_ = false;
+
+    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(EcoMaster, HandleUpdate));
+}
+
+void EcoMaster::Wake()
+{
+    SetLevel(ECO_AWAKE);
+}
+void EcoMaster::SetLevel(EcoLevel level)
+{
+    if (level == level_)
+        return;
+
+    level_ = level;
+
+    int fps{awakeFps_};
+    if (level_ == ECO_DROWSY)
+        fps = ECO_DROWSY_FPS;
+    else if (level_ == ECO_ASLEEP)
+        fps = ECO_SLEEP_FPS;
+
+    GetSubsystem<Engine>()->SetMaxFps(fps);
+    MC->world_.scene_->SetUpdateEnabled(level_ != ECO_ASLEEP);
+
+    Log::Write(LOG_DEBUG, "Eco level " + String(level_) + " at " + String(fps) + " fps");
+}
+
+void EcoMaster::HandleUpdate(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    if (!enabled_ || !MC->world_.scene_)
+        return;
+
+    InputMaster* inputMaster{GetSubsystem<InputMaster>()};
+    //Recordings need every frame at their fixed rate
+    if (!inputMaster->IsIdle() || FX->IsAnimating() || GetSubsystem<CaptureMaster>()->IsRecording()){
+
+        SetLevel(ECO_AWAKE);
+
+    } else if (inputMaster->IsCameraMoving() || !CAMERA->IsSettled()){
+
+        SetLevel(ECO_DROWSY);
+
+    } else {
+
+        SetLevel(ECO_ASLEEP);
+    }
+}
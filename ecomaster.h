@@ -0,0 +1,52 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef ECOMASTER_H
+#define ECOMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include "master.h"
+
+#define ECO_DROWSY_FPS 30
+#define ECO_SLEEP_FPS 10
+
+enum EcoLevel{ECO_AWAKE, ECO_DROWSY, ECO_ASLEEP};
+
+//Lowers the frame rate while nobody plays and nothing animates, and stops
+//updating the scene once the camera has come to rest as well.
+//Any input wakes it up again before that frame's scene update.
+class EcoMaster : public Master
+{
+    URHO3D_OBJECT(EcoMaster, Master);
+public:
+    EcoMaster(Context* context);
+
+    void Wake();
+    bool IsEnabled() const { return enabled_; }
+    bool IsAwake() const { return level_ == ECO_AWAKE; }
+    EcoLevel GetLevel() const { return level_; }
+private:
+    EcoLevel level_;
+    bool enabled_;
+    int awakeFps_;
+
+    void SetLevel(EcoLevel level);
+    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+};
+
+#endif // ECOMASTER_H
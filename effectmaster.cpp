@@ -16,86 +16,226 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
+#include <cmath>
+
 #include "effectmaster.h"
+#include "glowmodel.h"
 
 using namespace Urho3D;
 
-EffectMaster::EffectMaster(Context* context) : Master(context)
+namespace {
+const String matDiffColor{"MatDiffColor"};
+
+Vector4 ToVector4(const Vector3& vector) { return Vector4(vector, 0.0f); }
+Vector4 ToVector4(const Quaternion& quaternion) { return Vector4(quaternion.w_, quaternion.x_, quaternion.y_, quaternion.z_); }
+Vector4 ToVector4(float value) { return Vector4(value, 0.0f, 0.0f, 0.0f); }
+}
+
+EffectMaster::EffectMaster(Context* context) : Master(context),
+    targets_{},
+    channels_{},
+    curves_{},
+    starts_{},
+    durations_{},
+    from_{},
+    to_{},
+    archHeights_{},
+    numTweens_{0},
+    time_{0.0f}
 {
+    Reserve(TWEEN_CAPACITY);
+
+    //The scene sends this after its update event, where attribute animations ran before
+    SubscribeToEvent(E_ATTRIBUTEANIMATIONUPDATE, URHO3D_HANDLER(EffectMaster, HandleAnimationUpdate));
 }
 
-void EffectMaster::FadeTo(Material* material, Color color, float duration, float delay)
+void EffectMaster::Reserve(unsigned capacity)
 {
-    Color startColor{material->GetShaderParameter("MatDiffColor").GetColor()};
-    ValueAnimation* fade{new ValueAnimation(context_)};
+    targets_.Resize(capacity);
+    channels_.Resize(capacity);
+    curves_.Resize(capacity);
+    starts_.Resize(capacity);
+    durations_.Resize(capacity);
+    from_.Resize(capacity);
+    to_.Resize(capacity);
+    archHeights_.Resize(capacity);
+}
+//Takes over the slot of a tween running on the same target and channel
+void EffectMaster::Tween(Object* target, TweenChannel channel, TweenCurve curve, const Vector4& from, const Vector4& to,
+                         float duration, float delay, float archHeight)
+{
+    unsigned index{0};
+    while (index < numTweens_ && (targets_[index].Get() != target || channels_[index] != channel))
+        ++index;
+
+    if (index == numTweens_){
+
+        if (numTweens_ == targets_.Size())
+            Reserve(2 * numTweens_);
+
+        ++numTweens_;
+    }
+
+    targets_[index] = target;
+    channels_[index] = channel;
+    curves_[index] = curve;
+    starts_[index] = time_ + delay;
+    durations_[index] = duration;
+    from_[index] = from;
+    to_[index] = to;
+    archHeights_[index] = archHeight;
+}
+//Moves the last running tween into the freed slot
+void EffectMaster::Remove(unsigned index)
+{
+    unsigned last{--numTweens_};
+    if (index != last){
+
+        targets_[index] = targets_[last];
+        channels_[index] = channels_[last];
+        curves_[index] = curves_[last];
+        starts_[index] = starts_[last];
+        durations_[index] = durations_[last];
+        from_[index] = from_[last];
+        to_[index] = to_[last];
+        archHeights_[index] = archHeights_[last];
+    }
+    targets_[last].Reset();
+}
+//Leaves the target where it is
+void EffectMaster::Stop(Object* target)
+{
+    for (unsigned i{0}; i < numTweens_; )
+        if (targets_[i].Get() == target)
+            Remove(i);
+        else
+            ++i;
+}
+
+float EffectMaster::Ease(TweenCurve curve, float t) const
+{
+    //Ends land exactly on the start and end values
+    if (t <= 0.0f)
+        return 0.0f;
+    else if (t >= 1.0f)
+        return 1.0f;
+
+    switch (curve){
+    //Half way after 42% of the time
+    case TWEEN_GAIN_IN:
+        return t < 0.42f ? t * (0.5f / 0.42f)
+                         : 0.5f + (t - 0.42f) * (0.5f / 0.58f);
+    //Drops quickly and trails off
+    case TWEEN_GAIN_OUT:
+        return t < 0.2f  ? t * 2.5f
+             : t < 0.46f ? 0.5f + (t - 0.2f) * (0.4f / 0.26f)
+                         : 0.9f + (t - 0.46f) * (0.1f / 0.54f);
+    //Lingers around the top: t = 0.5 + 0.25 * (x + x^3) with x = 2s - 1, solved for s
+    case TWEEN_ARCH: {
+        float c{2.0f * t - 1.0f};
+        float root{sqrtf(c * c + 1.0f / 27.0f)};
+        return 0.5f * (std::cbrt(c + root) + std::cbrt(c - root) + 1.0f);
+    }
+    default: case TWEEN_LINEAR:
+        return t;
+    }
+}
+
+void EffectMaster::HandleAnimationUpdate(StringHash eventType, VariantMap& eventData)
+{ (void)eventType;
+
+    URHO3D_PROFILE(EffectAnimations);
+
+    time_ += eventData[AttributeAnimationUpdate::P_TIMESTEP].GetFloat();
 
-    fade->SetKeyFrame(0.0f, startColor);
-    if (delay)
-        fade->SetKeyFrame(delay, startColor);
-    fade->SetKeyFrame(delay + duration, color);
+    for (unsigned i{0}; i < numTweens_; ){
 
-    material->SetShaderParameterAnimation("MatDiffColor", fade, WM_ONCE);
+        Object* target{targets_[i].Get()};
+        if (!target){
+            Remove(i);
+            continue;
+        }
+
+        float t{durations_[i] > 0.0f ? Clamp((time_ - starts_[i]) / durations_[i], 0.0f, 1.0f)
+                                     : static_cast<float>(time_ >= starts_[i])};
+        float s{Ease(static_cast<TweenCurve>(curves_[i]), t)};
+        const Vector4& from{from_[i]};
+        const Vector4& to{to_[i]};
+
+        switch (channels_[i]){
+        case TC_POSITION: {
+            Vector3 position{Vector3(from.x_, from.y_, from.z_).Lerp(Vector3(to.x_, to.y_, to.z_), s)};
+            if (curves_[i] == TWEEN_ARCH)
+                position += Vector3::UP * archHeights_[i] * Arch(s);
+
+            static_cast<Node*>(target)->SetPosition(position);
+        } break;
+        case TC_ROTATION:
+            static_cast<Node*>(target)->SetRotation(Quaternion(from.x_, from.y_, from.z_, from.w_)
+                                                    .Slerp(Quaternion(to.x_, to.y_, to.z_, to.w_), s));
+            break;
+        case TC_GLOW_COLOR: {
+            Vector4 color{from.Lerp(to, s)};
+            static_cast<GlowModel*>(target)->SetColor(Color(color.x_, color.y_, color.z_, color.w_));
+        } break;
+        case TC_MATERIAL_COLOR: {
+            Vector4 color{from.Lerp(to, s)};
+            static_cast<Material*>(target)->SetShaderParameter(matDiffColor, Color(color.x_, color.y_, color.z_, color.w_));
+        } break;
+        case TC_BRIGHTNESS:
+            static_cast<Light*>(target)->SetBrightness(Lerp(from.x_, to.x_, s));
+            break;
+        case TC_GAIN:
+            static_cast<SoundSource*>(target)->SetGain(Lerp(from.x_, to.x_, s));
+            break;
+        default: break;
+        }
+
+        if (t >= 1.0f)
+            Remove(i);
+        else
+            ++i;
+    }
+}
+
+void EffectMaster::FadeTo(Material* material, Color color, float duration, float delay)
+{
+    Color startColor{material->GetShaderParameter(matDiffColor).GetColor()};
+    Tween(material, TC_MATERIAL_COLOR, TWEEN_LINEAR, startColor.ToVector4(), color.ToVector4(), duration, delay);
+}
+
+void EffectMaster::FadeTo(GlowModel* glow, Color color, float duration, float delay)
+{
+    Tween(glow, TC_GLOW_COLOR, TWEEN_LINEAR, glow->GetColor().ToVector4(), color.ToVector4(), duration, delay);
+}
+void EffectMaster::FadeOut(GlowModel* glow, float duration)
+{
+    FadeTo(glow, glow->GetColor() * 0.0f, duration);
 }
 
 void EffectMaster::FadeTo(Light* light, float brightness, float duration)
 {
-    ValueAnimation* fade{new ValueAnimation(context_)};
-    fade->SetKeyFrame(0.0f, light->GetBrightness());
-    fade->SetKeyFrame(duration, brightness);
-    light->SetAttributeAnimation("Brightness Multiplier", fade, WM_ONCE);
+    Tween(light, TC_BRIGHTNESS, TWEEN_LINEAR, ToVector4(light->GetBrightness()), ToVector4(brightness), duration);
 }
 
 void EffectMaster::FadeTo(SoundSource* soundSource, float gain, float duration)
 {
-    ValueAnimation* fade{new ValueAnimation(context_)};
-    fade->SetKeyFrame(0.0f, soundSource->GetGain());
-    fade->SetKeyFrame(0.42f * duration, Lerp(soundSource->GetGain(), gain, 0.5f));
-    fade->SetKeyFrame(duration, gain);
-    soundSource->SetAttributeAnimation("Gain", fade, WM_ONCE);
+    Tween(soundSource, TC_GAIN, TWEEN_GAIN_IN, ToVector4(soundSource->GetGain()), ToVector4(gain), duration);
 }
 void EffectMaster::FadeOut(SoundSource* soundSource, float duration)
 {
-    float lastGain{soundSource->GetGain()};
-
-    ValueAnimation* fade{new ValueAnimation(context_)};
-    fade->SetKeyFrame(0.0f, lastGain);
-    fade->SetKeyFrame(0.2f * duration, 0.5f * lastGain);
-    fade->SetKeyFrame(0.46f * duration, 0.1f * lastGain);
-    fade->SetKeyFrame(duration, 0.0f);
-    soundSource->SetAttributeAnimation("Gain", fade, WM_ONCE);
+    Tween(soundSource, TC_GAIN, TWEEN_GAIN_OUT, ToVector4(soundSource->GetGain()), ToVector4(0.0f), duration);
 }
 
 void EffectMaster::TransformTo(Node* node, Vector3 pos, Quaternion rot, float duration)
 {
-    ValueAnimation* posAnim{new ValueAnimation(context_)};
-    posAnim->SetKeyFrame(0.0f, node->GetPosition());
-    posAnim->SetKeyFrame(duration, pos);
-    node->SetAttributeAnimation("Position", posAnim, WM_ONCE);
-
-    ValueAnimation* rotAnim{new ValueAnimation(context_)};
-    rotAnim->SetKeyFrame(0.0f, node->GetRotation());
-    rotAnim->SetKeyFrame(duration, rot);
-    node->SetAttributeAnimation("Rotation", rotAnim, WM_ONCE);
+    Tween(node, TC_POSITION, TWEEN_LINEAR, ToVector4(node->GetPosition()), ToVector4(pos), duration);
+    Tween(node, TC_ROTATION, TWEEN_LINEAR, ToVector4(node->GetRotation()), ToVector4(rot), duration);
 }
 
+//The turn starts after the delay as well, but still ends at duration
 void EffectMaster::ArchTo(Node* node, Vector3 pos, Quaternion rot, float archHeight, float duration, float delay)
 {
-    ValueAnimation* posAnim{new ValueAnimation(context_)};
-    posAnim->SetKeyFrame(0.0f, node->GetPosition());
-
-    for (int i{0}; i < WAYPOINTS - 1; ++i){
-        float t{static_cast<float>(i) / WAYPOINTS};
-        float t2 = 0.5f * (t + (0.5f + 0.5f * pow(2.0f * (t - 0.5f), 3.0f)));
-        posAnim->SetKeyFrame(delay + (duration * t2),
-                             node->GetPosition().Lerp(pos, t) + archHeight * Vector3::UP * Arch(t));
-    }
-    posAnim->SetKeyFrame(delay + duration, pos);
-    node->SetAttributeAnimation("Position", posAnim, WM_ONCE);
-
-    ValueAnimation* rotAnim{new ValueAnimation(context_)};
-    rotAnim->SetKeyFrame(0.0f, node->GetRotation());
-    if (delay != 0.0f)
-        rotAnim->SetKeyFrame(delay, node->GetRotation());
-    rotAnim->SetKeyFrame(duration, rot);
-    node->SetAttributeAnimation("Rotation", rotAnim, WM_ONCE);
+    Tween(node, TC_POSITION, TWEEN_ARCH, ToVector4(node->GetPosition()), ToVector4(pos), duration, delay, archHeight);
+    Tween(node, TC_ROTATION, TWEEN_LINEAR, ToVector4(node->GetRotation()), ToVector4(rot), Max(duration - delay, 0.0f), delay);
 }
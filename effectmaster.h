@@ -22,8 +22,17 @@
 #include <Urho3D/Urho3D.h>
 #include "master.h"
 
-#define WAYPOINTS 42
+class GlowModel;
 
+#define TWEEN_CAPACITY 128
+
+//What a tween drives on its target, one running tween per target and channel
+enum TweenChannel{TC_POSITION, TC_ROTATION, TC_GLOW_COLOR, TC_MATERIAL_COLOR, TC_BRIGHTNESS, TC_GAIN};
+//Shape of the way from start to end value
+enum TweenCurve{TWEEN_LINEAR, TWEEN_GAIN_IN, TWEEN_GAIN_OUT, TWEEN_ARCH};
+
+//Runs every fade and move in one loop over preallocated arrays, so starting
+//an animation neither allocates nor builds keyframes.
 class EffectMaster : public Master
 {
     URHO3D_OBJECT(EffectMaster, Master);
@@ -31,16 +40,41 @@ public:
     EffectMaster(Context* context);
 
     void FadeTo(Material* material, Color color, float duration = 0.23f, float delay = 0.0f);
+    void FadeTo(GlowModel* glow, Color color, float duration = 0.23f, float delay = 0.0f);
     void FadeTo(Light* light, float brightness, float duration = 0.23f);
     void FadeTo(SoundSource* soundSource, float gain, float duration = 2.3f);
 
     void FadeOut(Material* material, float duration = 0.23f) {FadeTo(material, material->GetShaderParameter("MatDiffColor").GetColor() * 0.0f, duration); }
+    void FadeOut(GlowModel* glow, float duration = 0.23f);
     void FadeOut(Light* light) { FadeTo(light, 0.0f); }
     void FadeOut(SoundSource* soundSource, float duration = 5.0f);
 
     void TransformTo(Node* node, Vector3 pos, Quaternion rot = Quaternion::IDENTITY, float duration = 1.0f);
     void ArchTo(Node* node, Vector3 pos, Quaternion rot, float archHeight = 2.3f, float duration = 1.0f, float delay = 0.0f);
     float Arch(float t) const noexcept { return 1.0f - pow(2.0f * (t-0.5f), 4.0f); }
+    void Stop(Object* target);
+
+    bool IsAnimating() const { return numTweens_ != 0; }
+    unsigned GetNumAnimations() const { return numTweens_; }
+private:
+    //Parallel arrays, the first numTweens_ entries are running
+    Vector< WeakPtr<Object> > targets_;
+    PODVector<unsigned char> channels_;
+    PODVector<unsigned char> curves_;
+    PODVector<float> starts_;
+    PODVector<float> durations_;
+    PODVector<Vector4> from_;
+    PODVector<Vector4> to_;
+    PODVector<float> archHeights_;
+    unsigned numTweens_;
+    float time_;
+
+    void Tween(Object* target, TweenChannel channel, TweenCurve curve, const Vector4& from, const Vector4& to,
+               float duration, float delay = 0.0f, float archHeight = 0.0f);
+    void Reserve(unsigned capacity);
+    void Remove(unsigned index);
+    float Ease(TweenCurve curve, float t) const;
+    void HandleAnimationUpdate(StringHash eventType, VariantMap& eventData);
 };
 
 #endif // EFFECTMASTER_H
@@ -0,0 +1,203 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "glowmodel.h"
+
+bool GlowModel::instancing_{true};
+std::atomic<unsigned> GlowModel::glowFrame_{0};
+unsigned GlowModel::numOwnMaterials_{0};
+
+void GlowModel::RegisterObject(Context *context)
+{
+    context->RegisterFactory<GlowModel>();
+
+    URHO3D_COPY_BASE_ATTRIBUTES(AnimatedModel);
+    URHO3D_ACCESSOR_ATTRIBUTE("Glow Color", GetColor, SetColor, Color, Color::BLACK, AM_DEFAULT);
+}
+
+GlowModel::GlowModel(Context* context) : AnimatedModel(context),
+    color_{0.0f, 0.0f, 0.0f, 0.0f},
+    ownMaterial_{false}
+{
+}
+GlowModel::~GlowModel()
+{
+    if (ownMaterial_)
+        --numOwnMaterials_;
+}
+
+void GlowModel::UpdateBatches(const FrameInfo& frame)
+{
+    AnimatedModel::UpdateBatches(frame);
+
+    //Copied into the instancing buffer right after the world transform
+    for (SourceBatch& batch : batches_)
+        batch.instancingData_ = &color_;
+
+    //Only called for drawables in view, possibly from worker threads
+    if (color_.SumRGB() * color_.a_ > GLOW_THRESHOLD)
+        glowFrame_ = frame.frameNumber_;
+}
+//Whether any glow showed in the last rendered frame
+bool GlowModel::IsGlowVisible()
+{
+    return glowFrame_ + 1 >= TIME->GetFrameNumber();
+}
+
+//Poses that never change in between are baked into a model shared through the cache,
+//so the arrows skip the per instance morph blend and can still be instanced.
+void GlowModel::SetPose(Model* model, const PODVector<float>& weights)
+{
+    String name{model->GetName() + "#pose"};
+    for (float weight : weights)
+        name += " " + String(weight);
+
+    ResourceCache* cache{GetSubsystem<ResourceCache>()};
+    Model* posed{cache->GetExistingResource<Model>(name)};
+    if (!posed){
+
+        SharedPtr<Model> baked{model->Clone(name)};
+        for (unsigned m{0}; m < weights.Size() && m < baked->GetNumMorphs(); ++m)
+            if (weights[m] != 0.0f)
+                ApplyMorph(baked, baked->GetMorphs()[m], weights[m]);
+
+        baked->SetMorphs(Vector<ModelMorph>{});
+        cache->AddManualResource(baked);
+        posed = baked;
+    }
+    if (GetModel() != posed)
+        SetModel(posed);
+}
+//Moves the position deltas of a morph into a second vertex stream,
+//for the GlowPulse shader to blend in with the elapsed time.
+void GlowModel::SetPulsingModel(Model* model, unsigned morph)
+{
+    if (morph >= model->GetNumMorphs()){
+        SetModel(model);
+        return;
+    }
+
+    String name{model->GetName() + "#pulse"};
+    ResourceCache* cache{GetSubsystem<ResourceCache>()};
+    Model* pulsing{cache->GetExistingResource<Model>(name)};
+    if (!pulsing){
+
+        SharedPtr<Model> baked{model->Clone(name)};
+        const Vector<SharedPtr<VertexBuffer> >& buffers{baked->GetVertexBuffers()};
+        const ModelMorph& source{baked->GetMorphs()[morph]};
+        PODVector<VertexElement> elements{};
+        elements.Push(VertexElement(TYPE_VECTOR3, SEM_TEXCOORD, 2));
+
+        HashMap<VertexBuffer*, SharedPtr<VertexBuffer> > deltaBuffers{};
+        for (unsigned b{0}; b < buffers.Size(); ++b){
+
+            PODVector<Vector3> deltas(buffers[b]->GetVertexCount(), Vector3::ZERO);
+            HashMap<unsigned, VertexBufferMorph>::ConstIterator bufferMorph{source.buffers_.Find(b)};
+            if (bufferMorph != source.buffers_.End() && bufferMorph->second_.elementMask_ & MASK_POSITION){
+
+                const VertexBufferMorph& deltaData{bufferMorph->second_};
+                unsigned stride{static_cast<unsigned>(sizeof(unsigned) + sizeof(Vector3)
+                            * (1 + !!(deltaData.elementMask_ & MASK_NORMAL) + !!(deltaData.elementMask_ & MASK_TANGENT)))};
+                for (unsigned v{0}; v < deltaData.vertexCount_; ++v){
+
+                    const unsigned char* entry{deltaData.morphData_.Get() + v * stride};
+                    unsigned index{*reinterpret_cast<const unsigned*>(entry)};
+                    if (index < deltas.Size())
+                        deltas[index] += *reinterpret_cast<const Vector3*>(entry + sizeof(unsigned));
+                }
+            }
+
+            SharedPtr<VertexBuffer> deltaBuffer{new VertexBuffer(context_)};
+            deltaBuffer->SetShadowed(true);
+            deltaBuffer->SetSize(deltas.Size(), elements);
+            deltaBuffer->SetData(&deltas[0]);
+            deltaBuffers[buffers[b]] = deltaBuffer;
+        }
+
+        for (unsigned g{0}; g < baked->GetNumGeometries(); ++g)
+            for (unsigned l{0}; l < baked->GetNumGeometryLodLevels(g); ++l){
+
+                Geometry* geometry{baked->GetGeometry(g, l)};
+                VertexBuffer* vertices{geometry->GetVertexBuffer(0)};
+                if (deltaBuffers.Contains(vertices)){
+
+                    geometry->SetNumVertexBuffers(2);
+                    geometry->SetVertexBuffer(1, deltaBuffers[vertices]);
+                }
+            }
+
+        baked->SetMorphs(Vector<ModelMorph>{});
+        cache->AddManualResource(baked);
+        pulsing = baked;
+    }
+    SetModel(pulsing);
+}
+//Same blend AnimatedModel does every frame, done once into the shadow data
+void GlowModel::ApplyMorph(Model* model, const ModelMorph& morph, float weight)
+{
+    //Deltas are stored in this order after each vertex index
+    const Pair<VertexElementSemantic, unsigned> morphElements[]{
+        {SEM_POSITION, MASK_POSITION}, {SEM_NORMAL, MASK_NORMAL}, {SEM_TANGENT, MASK_TANGENT}};
+
+    for (HashMap<unsigned, VertexBufferMorph>::ConstIterator i{morph.buffers_.Begin()}; i != morph.buffers_.End(); ++i){
+
+        VertexBuffer* buffer{model->GetVertexBuffers()[i->first_]};
+        const VertexBufferMorph& bufferMorph{i->second_};
+        unsigned char* vertices{buffer->GetShadowData()};
+        if (!vertices)
+            continue;
+
+        unsigned vertexSize{buffer->GetVertexSize()};
+        const unsigned char* source{bufferMorph.morphData_.Get()};
+        for (unsigned v{0}; v < bufferMorph.vertexCount_; ++v){
+
+            unsigned char* vertex{vertices + *reinterpret_cast<const unsigned*>(source) * vertexSize};
+            source += sizeof(unsigned);
+
+            for (const Pair<VertexElementSemantic, unsigned>& element : morphElements){
+
+                if (!(bufferMorph.elementMask_ & element.second_))
+                    continue;
+
+                if (buffer->HasElement(element.first_)){
+
+                    Vector3& value{*reinterpret_cast<Vector3*>(vertex + buffer->GetElementOffset(element.first_))};
+                    value += weight * *reinterpret_cast<const Vector3*>(source);
+                }
+                source += sizeof(Vector3);
+            }
+        }
+        buffer->SetData(vertices);
+    }
+}
+
+void GlowModel::SetColor(const Color& color)
+{
+    color_ = color;
+
+    //Without hardware instancing every glow needs a material of its own after all
+    if (!instancing_ && GetMaterial()){
+
+        if (!ownMaterial_){
+            SetMaterial(GetMaterial()->Clone());
+            ownMaterial_ = true;
+            ++numOwnMaterials_;
+        }
+        GetMaterial()->SetShaderParameter("MatDiffColor", color_);
+    }
+}
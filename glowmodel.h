@@ -0,0 +1,60 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef GLOWMODEL_H
+#define GLOWMODEL_H
+
+#include <Urho3D/Urho3D.h>
+#include <Urho3D/Graphics/Geometry.h>
+#include <Urho3D/Graphics/VertexBuffer.h>
+#include <atomic>
+
+#include "luckey.h"
+
+//Dimmer glows than this are not worth a bloom pass
+#define GLOW_THRESHOLD 0.05f
+
+//Model drawn with the one shared Glow material. Its color travels along with
+//the instance transform, so all glows batch together without material clones.
+class GlowModel : public AnimatedModel
+{
+    URHO3D_OBJECT(GlowModel, AnimatedModel);
+public:
+    GlowModel(Context* context);
+    virtual ~GlowModel();
+    static void RegisterObject(Context* context);
+    static void SetInstancing(bool enable) { instancing_ = enable; }
+    static bool IsGlowVisible();
+    static unsigned GetNumOwnMaterials() { return numOwnMaterials_; }
+    virtual void UpdateBatches(const FrameInfo& frame);
+
+    void SetPose(Model* model, const PODVector<float>& weights);
+    void SetPulsingModel(Model* model, unsigned morph = 0);
+    void SetColor(const Color& color);
+    const Color& GetColor() const { return color_; }
+private:
+    static bool instancing_;
+    static std::atomic<unsigned> glowFrame_;
+    static unsigned numOwnMaterials_;
+    static void ApplyMorph(Model* model, const ModelMorph& morph, float weight);
+
+    Color color_;
+    bool ownMaterial_;
+};
+
+#endif // GLOWMODEL_H
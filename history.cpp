@@ -0,0 +1,63 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "history.h"
+
+History::History():
+    entries_{},
+    first_{0},
+    current_{0},
+    size_{1}
+{
+    entries_[0] = Position::Start();
+}
+
+void History::Clear(const Position& start)
+{
+    first_ = 0;
+    current_ = 0;
+    size_ = 1;
+    entries_[0] = start;
+}
+void History::Push(const Position& position)
+{
+    //Forget the oldest step when full
+    if (current_ + 1 == HISTORY_CAPACITY){
+        first_ = (first_ + 1) % HISTORY_CAPACITY;
+        --current_;
+    }
+
+    ++current_;
+    size_ = current_ + 1;
+    entries_[(first_ + current_) % HISTORY_CAPACITY] = position;
+}
+
+const Position& History::Undo()
+{
+    if (CanUndo())
+        --current_;
+
+    return Current();
+}
+const Position& History::Redo()
+{
+    if (CanRedo())
+        ++current_;
+
+    return Current();
+}
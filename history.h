@@ -0,0 +1,56 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "position.h"
+
+//A full game is at most 32 plies past the start
+#define HISTORY_CAPACITY 64
+
+//Fixed-capacity ring of positions. Making a move pushes a copy, undo and redo
+//only move the cursor, so every step is constant time and allocation free.
+//Making a move after an undo drops the redo branch, which is how variations
+//are explored.
+class History
+{
+public:
+    History();
+
+    void Clear(const Position& start);
+    void Push(const Position& position);
+
+    bool CanUndo() const noexcept { return current_ > 0; }
+    bool CanRedo() const noexcept { return current_ + 1 < size_; }
+    const Position& Undo();
+    const Position& Redo();
+
+    const Position& Current() const noexcept { return At(current_); }
+    unsigned Size() const noexcept { return size_; }
+    unsigned GetCursor() const noexcept { return current_; }
+private:
+    Position entries_[HISTORY_CAPACITY];
+    unsigned first_;
+    unsigned current_;
+    unsigned size_;
+
+    const Position& At(unsigned index) const noexcept { return entries_[(first_ + index) % HISTORY_CAPACITY]; }
+};
+
+#endif // HISTORY_H
@@ -0,0 +1,125 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "hudmaster.h"
+#include "effectmaster.h"
+#include "lightmaster.h"
+#include "qualitymaster.h"
+#include "glowmodel.h"
+
+HudMaster::HudMaster(Context* context) : Master(context),
+    graph_{},
+    bars_{},
+    budgetLine_{},
+    frameTimes_(HUD_GRAPH_FRAMES, 0.0f),
+    head_{0},
+    frameTimer_{},
+    visible_{false}
+{
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(HudMaster, HandleBeginFrame));
+    SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(HudMaster, HandlePostUpdate));
+}
+
+//The debug HUD and graph are only created once they are first asked for
+void HudMaster::Toggle()
+{
+    DebugHud* debugHud{GetSubsystem<DebugHud>()};
+    if (!debugHud){
+
+        debugHud = ENGINE->CreateDebugHud();
+        debugHud->SetDefaultStyle(CACHE->GetResource<XMLFile>("UI/HudStyle.xml"));
+        CreateGraph();
+    }
+
+    visible_ = !visible_;
+    debugHud->SetMode(visible_ ? DEBUGHUD_SHOW_ALL : DEBUGHUD_SHOW_NONE);
+    graph_->SetVisible(visible_);
+
+    UpdateStats();
+    UpdateGraph();
+}
+void HudMaster::CreateGraph()
+{
+    graph_ = GetSubsystem<UI>()->GetRoot()->CreateChild<BorderImage>();
+    graph_->SetColor(Color(0.0f, 0.0f, 0.0f, 0.42f));
+    graph_->SetSize(HUD_GRAPH_FRAMES * HUD_BAR_WIDTH, HUD_GRAPH_HEIGHT);
+    graph_->SetAlignment(HA_RIGHT, VA_BOTTOM);
+    graph_->SetPosition(-8, -8);
+
+    for (int b{0}; b < HUD_GRAPH_FRAMES; ++b){
+
+        BorderImage* bar{graph_->CreateChild<BorderImage>()};
+        bar->SetAlignment(HA_LEFT, VA_BOTTOM);
+        bar->SetPosition(b * HUD_BAR_WIDTH, 0);
+        bars_.Push(SharedPtr<BorderImage>(bar));
+    }
+
+    budgetLine_ = graph_->CreateChild<BorderImage>();
+    budgetLine_->SetColor(Color(0.8f, 0.9f, 0.95f, 0.5f));
+    budgetLine_->SetSize(HUD_GRAPH_FRAMES * HUD_BAR_WIDTH, 1);
+    budgetLine_->SetAlignment(HA_LEFT, VA_BOTTOM);
+}
+
+//Oldest frame on the left, frames over budget in red
+void HudMaster::UpdateGraph()
+{
+    if (!visible_)
+        return;
+
+    float budget{GetSubsystem<QualityMaster>()->GetBudget()};
+    budgetLine_->SetPosition(0, -Min(RoundToInt(budget * 1000.0f * HUD_MS_HEIGHT), HUD_GRAPH_HEIGHT - 1));
+
+    for (unsigned b{0}; b < bars_.Size(); ++b){
+
+        float frameTime{frameTimes_[(head_ + b) % HUD_GRAPH_FRAMES]};
+        BorderImage* bar{bars_[b]};
+        bar->SetSize(HUD_BAR_WIDTH, Min(RoundToInt(frameTime * 1000.0f * HUD_MS_HEIGHT), HUD_GRAPH_HEIGHT));
+        bar->SetColor(frameTime > budget ? Color(1.0f, 0.3f, 0.2f, 0.9f)
+                                         : Color(0.125f, 1.0f, 0.666f, 0.8f));
+    }
+}
+//Batches, lights and shadow maps are in the HUD's own statistics already
+void HudMaster::UpdateStats()
+{
+    DebugHud* debugHud{GetSubsystem<DebugHud>()};
+    if (!visible_ || !debugHud)
+        return;
+
+    LightMaster* lightMaster{LIGHTS};
+    float frameTime{frameTimes_[(head_ + HUD_GRAPH_FRAMES - 1) % HUD_GRAPH_FRAMES]};
+
+    debugHud->SetAppStats("Frame", String(RoundToInt(frameTime * 10000.0f) * 0.1f) + " ms");
+    debugHud->SetAppStats("Quality", String(GetSubsystem<QualityMaster>()->GetLevel()));
+    debugHud->SetAppStats("Animations", String(FX->GetNumAnimations()));
+    debugHud->SetAppStats("Managed lights", String(lightMaster->GetNumEnabled()) + " / " + String(lightMaster->GetNumLights())
+                          + " (" + String(lightMaster->GetNumPerPixel()) + " per pixel)");
+    debugHud->SetAppStats("Cloned materials", String(GlowModel::GetNumOwnMaterials()));
+}
+
+void HudMaster::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    frameTimes_[head_] = frameTimer_.GetUSec(true) * 0.000001f;
+    head_ = (head_ + 1) % HUD_GRAPH_FRAMES;
+}
+void HudMaster::HandlePostUpdate(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    UpdateStats();
+    UpdateGraph();
+}
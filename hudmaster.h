@@ -0,0 +1,59 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef HUDMASTER_H
+#define HUDMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/UI/BorderImage.h>
+
+#include "master.h"
+
+#define HUD_GRAPH_FRAMES 120
+#define HUD_GRAPH_HEIGHT 100
+#define HUD_BAR_WIDTH 2
+#define HUD_MS_HEIGHT 3.0f
+
+//Shows the engine's debug HUD, with the profiler blocks of every subsystem,
+//next to a graph of recent frame times and counts of live effects.
+class HudMaster : public Master
+{
+    URHO3D_OBJECT(HudMaster, Master);
+public:
+    HudMaster(Context* context);
+
+    void Toggle();
+    bool IsVisible() const { return visible_; }
+private:
+    SharedPtr<BorderImage> graph_;
+    Vector< SharedPtr<BorderImage> > bars_;
+    SharedPtr<BorderImage> budgetLine_;
+    PODVector<float> frameTimes_;
+    unsigned head_;
+    HiresTimer frameTimer_;
+    bool visible_;
+
+    void CreateGraph();
+    void UpdateGraph();
+    void UpdateStats();
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    void HandlePostUpdate(StringHash eventType, VariantMap& eventData);
+};
+
+#endif // HUDMASTER_H
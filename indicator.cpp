@@ -17,13 +17,15 @@
 */
 
 #include "indicator.h"
+#include "lightmaster.h"
 
 void Indicator::RegisterObject(Context *context)
 {
     context->RegisterFactory<Indicator>();
 }
 
-Indicator::Indicator(Context* context) : LogicComponent(context)
+Indicator::Indicator(Context* context) : LogicComponent(context),
+    long_{false}
 {
 
 }
@@ -31,15 +33,14 @@ Indicator::Indicator(Context* context) : LogicComponent(context)
 void Indicator::OnNodeSet(Node *node)
 { (void)node;
 
-    glow_ = MC->GetMaterial("Glow")->Clone();
     //Create nodes and models
     arrowNode1_ = node_->CreateChild("Arrow");
     arrowNode1_->Rotate(Quaternion(-90.0f, Vector3::UP));
-    model1_ = arrowNode1_->CreateComponent<AnimatedModel>();
+    model1_ = arrowNode1_->CreateComponent<GlowModel>();
 
     arrowNode2_ = node_->CreateChild("Arrow");
     arrowNode2_->Rotate(Quaternion(90.0f, Vector3::UP));
-    model2_ = arrowNode2_->CreateComponent<AnimatedModel>();
+    model2_ = arrowNode2_->CreateComponent<GlowModel>();
 
     //Create lights
     Node* lightNode1{arrowNode1_->CreateChild("Light")};
@@ -49,6 +50,7 @@ void Indicator::OnNodeSet(Node *node)
     light1_->SetBrightness(0.023f);
     light1_->SetRange(2.0f);
     light1_->SetCastShadows(false);
+    LIGHTS->Register(light1_, 0.75f);
 
     Node* lightNode2{arrowNode2_->CreateChild("Light")};
     lightNode2->SetPosition(Vector3::UP * 0.23f);
@@ -57,6 +59,7 @@ void Indicator::OnNodeSet(Node *node)
     light2_->SetBrightness(0.023f);
     light2_->SetRange(2.0f);
     light2_->SetCastShadows(false);
+    LIGHTS->Register(light2_, 0.75f);
 }
 
 void Indicator::Init(int nth)
@@ -80,21 +83,28 @@ void Indicator::Init(int nth)
 
     if (nth < 4) {
 
-        model1_->SetModel(MC->GetModel("Arrow"));
-        model1_->SetMorphWeight(0, static_cast<float>(nth < 2));
-
-        model2_->SetModel(MC->GetModel("Arrow"));
-        model2_->SetMorphWeight(0, static_cast<float>(nth < 2));
+        long_ = nth < 2;
+        SetExtended(false);
 
     } else {
 
-        model1_->SetModel(MC->GetModel("BlockIndicator"));
-        model2_->SetModel(MC->GetModel("BlockIndicator"));
+        model1_->SetModel(MC->GetModel(MDL_BLOCK_INDICATOR));
+        model2_->SetModel(MC->GetModel(MDL_BLOCK_INDICATOR));
     }
 
-    model1_->SetMaterial(glow_);
-    model2_->SetMaterial(glow_);
-    model2_->GetMaterial()->SetShaderParameter("MatDiffColor", Color(0.0f, 0.0f, 0.0f, 0.0f));
-}
+    for (GlowModel* model : {model1_.Get(), model2_.Get()}){
 
+        model->SetMaterial(MC->GetMaterial(MAT_GLOW));
+        model->SetColor(Color(0.0f, 0.0f, 0.0f, 0.0f));
+    }
+}
+//Picks one of the baked arrow poses, Length1 for rows and columns, Length2 to reach past the middle squares
+void Indicator::SetExtended(bool extended)
+{
+    PODVector<float> weights{};
+    weights.Push(static_cast<float>(long_));
+    weights.Push(static_cast<float>(extended));
 
+    for (GlowModel* model : {model1_.Get(), model2_.Get()})
+        model->SetPose(MC->GetModel(MDL_ARROW), weights);
+}
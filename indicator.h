@@ -23,6 +23,7 @@
 
 #include "mastercontrol.h"
 #include "luckey.h"
+#include "glowmodel.h"
 
 class Indicator : public LogicComponent
 {
@@ -36,13 +37,14 @@ public:
 private:
     Node* arrowNode1_;
     Node* arrowNode2_;
-    SharedPtr<Material> glow_;
-    SharedPtr<AnimatedModel> model1_;
-    SharedPtr<AnimatedModel> model2_;
+    SharedPtr<GlowModel> model1_;
+    SharedPtr<GlowModel> model2_;
     SharedPtr<Light> light1_;
     SharedPtr<Light> light2_;
+    bool long_;
 
     void Init(int nth);
+    void SetExtended(bool extended);
 };
 
 #endif // INDICATOR_H
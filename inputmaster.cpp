@@ -18,6 +18,11 @@
 
 #include "inputmaster.h"
 #include "effectmaster.h"
+#include "ecomaster.h"
+#include "qualitymaster.h"
+#include "hudmaster.h"
+#include "capturemaster.h"
+#include "sessionmaster.h"
 #include "quattercam.h"
 #include "board.h"
 #include "piece.h"
@@ -40,20 +45,26 @@ InputMaster::InputMaster(Context* context) : Master(context),
     mouseMoveSinceClick_{},
     smoothCamRotate_{},
     smoothCamZoom_{},
+    session_{GetSubsystem<SessionMaster>()},
     yad_{},
     rayPiece_{},
-    raySquare_{}
+    raySquare_{},
+    pick_{}
 {
+    pick_.frame_ = M_MAX_UNSIGNED;
+
     INPUT->SetMouseMode(MM_FREE);
 
-    SubscribeToEvent(E_MOUSEMOVE, URHO3D_HANDLER(InputMaster, HandleMouseMove));
-    SubscribeToEvent(E_MOUSEBUTTONDOWN, URHO3D_HANDLER(InputMaster, HandleMouseButtonDown));
-    SubscribeToEvent(E_MOUSEBUTTONUP, URHO3D_HANDLER(InputMaster, HandleMouseButtonUp));
-    SubscribeToEvent(E_MOUSEWHEEL, URHO3D_HANDLER(InputMaster, HandleMouseWheel));
-    SubscribeToEvent(E_KEYDOWN, URHO3D_HANDLER(InputMaster, HandleKeyDown));
-    SubscribeToEvent(E_KEYUP, URHO3D_HANDLER(InputMaster, HandleKeyUp));
-    SubscribeToEvent(E_JOYSTICKBUTTONDOWN, URHO3D_HANDLER(InputMaster, HandleJoystickButtonDown));
-    SubscribeToEvent(E_JOYSTICKBUTTONUP, URHO3D_HANDLER(InputMaster, HandleJoystickButtonUp));
+    //Played back sessions take the place of the devices
+    Object* source{session_->IsPlaying() ? static_cast<Object*>(session_) : INPUT};
+    SubscribeToEvent(source, E_MOUSEMOVE, URHO3D_HANDLER(InputMaster, HandleMouseMove));
+    SubscribeToEvent(source, E_MOUSEBUTTONDOWN, URHO3D_HANDLER(InputMaster, HandleMouseButtonDown));
+    SubscribeToEvent(source, E_MOUSEBUTTONUP, URHO3D_HANDLER(InputMaster, HandleMouseButtonUp));
+    SubscribeToEvent(source, E_MOUSEWHEEL, URHO3D_HANDLER(InputMaster, HandleMouseWheel));
+    SubscribeToEvent(source, E_KEYDOWN, URHO3D_HANDLER(InputMaster, HandleKeyDown));
+    SubscribeToEvent(source, E_KEYUP, URHO3D_HANDLER(InputMaster, HandleKeyUp));
+    SubscribeToEvent(source, E_JOYSTICKBUTTONDOWN, URHO3D_HANDLER(InputMaster, HandleJoystickButtonDown));
+    SubscribeToEvent(source, E_JOYSTICKBUTTONUP, URHO3D_HANDLER(InputMaster, HandleJoystickButtonUp));
     SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(InputMaster, HandleUpdate));
 }
 
@@ -69,6 +80,8 @@ void InputMaster::ConstructYad()
 void InputMaster::HandleUpdate(StringHash eventType, VariantMap &eventData)
 { (void)eventType;
 
+    URHO3D_PROFILE(InputUpdate);
+
     float t{eventData[Update::P_TIMESTEP].GetFloat()};
     idleTime_ += t;
     mouseIdleTime_ += t;
@@ -126,7 +139,28 @@ void InputMaster::HandleKeyDown(StringHash eventType, VariantMap &eventData)
         } else MC->Exit();
     } break;
     case KEY_9:{
-        MC->TakeScreenshot();
+        GetSubsystem<CaptureMaster>()->Screenshot();
+    } break;
+    case KEY_F9:{
+        GetSubsystem<CaptureMaster>()->ToggleRecording();
+    } break;
+    case KEY_F2:{
+        GetSubsystem<HudMaster>()->Toggle();
+    } break;
+    case KEY_F3:{
+        GetSubsystem<QualityMaster>()->ToggleOverlay();
+    } break;
+    case KEY_Z: {
+        if (session_->GetQualifierDown(QUAL_CTRL)){
+            if (session_->GetQualifierDown(QUAL_SHIFT))
+                MC->Redo();
+            else
+                MC->Undo();
+        }
+    } break;
+    case KEY_Y: {
+        if (session_->GetQualifierDown(QUAL_CTRL))
+            MC->Redo();
     } break;
     case KEY_M: {
         MC->NextMusicState();
@@ -309,6 +343,8 @@ void InputMaster::UpdateYad()
 }
 Vector3 InputMaster::YadRaycast(bool& none)
 {
+    URHO3D_PROFILE(YadRaycast);
+
     bool square{false};
     if (!drag_){
         //Select piece and hide yad when hovering over a piece in a pick state
@@ -335,12 +371,8 @@ Vector3 InputMaster::YadRaycast(bool& none)
         }
     }
 
-    Ray cameraRay{MouseRay()};
-    PODVector<RayQueryResult> results;
-    RayOctreeQuery query(results, cameraRay, RAY_TRIANGLE, 1000.0f, DRAWABLE_GEOMETRY);
-    MC->world_.scene_->GetComponent<Octree>()->Raycast(query);
-
-    for (RayQueryResult r : results){
+    const MousePick& pick{PickMouse()};
+    if (pick.hit_){
         if (MC->InPickState()){
             MC->DeselectPiece();
         } else if (MC->InPutState()
@@ -353,10 +385,8 @@ Vector3 InputMaster::YadRaycast(bool& none)
         }
         if (yad_->hidden_ && !drag_)
             yad_->Reveal();
-        if (!r.node_->HasTag("Piece")
-         && !r.node_->HasTag("Square")
-         && !r.node_->HasTag("Yad"))
-            return r.position_; //return
+        if (pick.surface_)
+            return pick.surfacePosition_; //return
     }
     none = true;
     return Vector3::ZERO; //return
@@ -418,38 +448,38 @@ void InputMaster::HandleJoystickButtons()
 }
 bool InputMaster::CorrectJoystickId(int joystickId)
 {
-    return INPUT->GetJoystickByIndex(joystickId) == GetActiveJoystick();
+    return (session_->HasJoystick(joystickId) ? joystickId : -1) == GetActiveJoystick();
 }
-JoystickState* InputMaster::GetActiveJoystick()
+int InputMaster::GetActiveJoystick()
 {
-    if (INPUT->GetNumJoysticks() > 1) {
+    if (session_->GetNumJoysticks() > 1) {
 
         if (MC->InPlayer1State())
         {
-            return INPUT->GetJoystickByIndex(0);
+            return 0;
 
         } else if (MC->InPlayer2State())
         {
-            return INPUT->GetJoystickByIndex(1);
+            return 1;
         } else if (MC->GetGameState() == GameState::QUATTER) {
             if (MC->GetPreviousGameState() == GameState::PLAYER1PICKS ||
                 MC->GetPreviousGameState() == GameState::PLAYER1PUTS)
             {
-                return INPUT->GetJoystickByIndex(0);
+                return 0;
 
             } else if (MC->GetPreviousGameState() == GameState::PLAYER2PICKS ||
                        MC->GetPreviousGameState() == GameState::PLAYER2PUTS)
             {
-                return INPUT->GetJoystickByIndex(1);
+                return 1;
             }
         }
 
-    } else if (INPUT->GetJoystickByIndex(0)) {
+    } else if (session_->HasJoystick(0)) {
 
-        return INPUT->GetJoystickByIndex(0);
+        return 0;
 
     }
-    return nullptr;
+    return -1;
 }
 void InputMaster::HandleJoystickButtonDown(StringHash eventType, VariantMap &eventData)
 { (void)eventType;
@@ -458,7 +488,16 @@ void InputMaster::HandleJoystickButtonDown(StringHash eventType, VariantMap &eve
     int joystickId{eventData[P_JOYSTICKID].GetInt()};
     int button{eventData[P_BUTTON].GetInt()};
 
-    if (INPUT->GetNumJoysticks() > 1
+    //Either player may take back or replay a move
+    if (button == LucKey::SB_L1){
+        MC->Undo();
+        return;
+    } else if (button == LucKey::SB_R1){
+        MC->Redo();
+        return;
+    }
+
+    if (session_->GetNumJoysticks() > 1
      && !CorrectJoystickId(joystickId)
      && MC->GetGameState() != GameState::QUATTER) return;
 
@@ -532,14 +571,14 @@ void InputMaster::HandleCameraMovement(float t)
 
     //Mouse rotate
     if (drag_){
-        IntVector2 mouseMove{INPUT->GetMouseMove()};
+        IntVector2 mouseMove{session_->GetMouseMove()};
         camRot += Vector2(mouseMove.x_, mouseMove.y_) * 0.1f;
     }
     //Joystick camera movement
-    JoystickState* joy{GetActiveJoystick()};
-    if (joy){
-        Vector2 rotation{-Vector2(joy->GetAxisPosition(0), joy->GetAxisPosition(1))
-                         -Vector2(joy->GetAxisPosition(2), joy->GetAxisPosition(3))};
+    int joy{GetActiveJoystick()};
+    if (joy >= 0){
+        Vector2 rotation{-Vector2(session_->GetAxisPosition(joy, 0), session_->GetAxisPosition(joy, 1))
+                         -Vector2(session_->GetAxisPosition(joy, 2), session_->GetAxisPosition(joy, 3))};
 
         if (Abs(rotation.x_) < DEADZONE) rotation.x_ = 0;
         else {
@@ -558,7 +597,7 @@ void InputMaster::HandleCameraMovement(float t)
             camRot += rotation * t * joyRotMultiplier;
         }
 
-        float zoom{Clamp(joy->GetAxisPosition(13) - joy->GetAxisPosition(12),
+        float zoom{Clamp(session_->GetAxisPosition(joy, 13) - session_->GetAxisPosition(joy, 12),
                          -1.0f, 1.0f)};
 
         if (Abs(zoom) < DEADZONE){
@@ -581,6 +620,9 @@ void InputMaster::HandleCameraMovement(float t)
     //Slowly spin camera when there hasn't been any input for a while
     if (idle_){
         float idleStartup{Min(0.5f * (idleTime_ - IDLE_THRESHOLD), 1.0f)};
+        //Come to rest after a while so the eco scheduler can let the cabinet sleep
+        if (GetSubsystem<EcoMaster>()->IsEnabled())
+            idleStartup *= Clamp(0.1f * (IDLE_THRESHOLD + IDLE_ORBIT_TIME - idleTime_), 0.0f, 1.0f);
         camRot += Vector2(t * idleStartup * -0.5f,
                           t * idleStartup * MC->Sine(0.23f, -0.042f, 0.042f));
     }
@@ -635,6 +677,8 @@ void InputMaster::SetIdle()
 }
 void InputMaster::ResetIdle()
 {
+    GetSubsystem<EcoMaster>()->Wake();
+
     if (idle_) {
 
         idle_ = false;
@@ -650,75 +694,39 @@ void InputMaster::ResetIdle()
     idleTime_ = 0.0f;
 }
 
-Piece* InputMaster::RaycastToPiece()
+//Every raycast under the cursor shares one proxy pick per frame and mouse ray
+const MousePick& InputMaster::PickMouse()
 {
     Ray cameraRay{MouseRay()};
+    unsigned frame{TIME->GetFrameNumber()};
+    if (pick_.frame_ == frame && pick_.ray_ == cameraRay)
+        return pick_;
 
-    PODVector<RayQueryResult> results;
-    RayOctreeQuery query(results, cameraRay, RAY_TRIANGLE, 1000.0f, DRAWABLE_GEOMETRY);
-    MC->world_.scene_->GetComponent<Octree>()->Raycast(query);
+    URHO3D_PROFILE(InputRaycast);
 
-    for (RayQueryResult r : results){
+    pick_.ray_ = cameraRay;
+    pick_.frame_ = frame;
+    GetSubsystem<PickMaster>()->Pick(cameraRay, pick_);
 
-        for (Piece* p : MC->world_.pieces_)
-            if (r.node_ == p->GetNode()){
-                rayPiece_ = p;
-                return p;
-            }
-    }
-    rayPiece_ = nullptr;
-    return nullptr;
+    return pick_;
+}
+Piece* InputMaster::RaycastToPiece()
+{
+    rayPiece_ = PickMouse().piece_;
+    return rayPiece_;
 }
 Square* InputMaster::RaycastToSquare()
 {
-    Ray cameraRay{MouseRay()};
-
-    PODVector<RayQueryResult> results;
-    RayOctreeQuery query(results, cameraRay, RAY_TRIANGLE, 1000.0f, DRAWABLE_GEOMETRY);
-    MC->world_.scene_->GetComponent<Octree>()->Raycast(query);
-
-    for (RayQueryResult r : results){
-
-        for (Square* s : BOARD->GetSquares())
-            if (r.node_ == s->GetNode()){
-                raySquare_ = s;
-                return s;
-            }
-    }
-    raySquare_ = nullptr;
-    return nullptr;
+    raySquare_ = PickMouse().square_;
+    return raySquare_;
 }
 bool InputMaster::RaycastToBoard()
 {
-    Ray cameraRay{MouseRay()};
-
-    PODVector<RayQueryResult> results;
-    RayOctreeQuery query(results, cameraRay, RAY_TRIANGLE, 1000.0f, DRAWABLE_GEOMETRY);
-    MC->world_.scene_->GetComponent<Octree>()->Raycast(query);
-
-    for (RayQueryResult r : results){
-
-            if (r.node_->HasTag("Board")){
-                return true;
-            }
-    }
-    return false;
+    return PickMouse().board_;
 }
 bool InputMaster::RaycastToTable()
 {
-    Ray cameraRay{MouseRay()};
-
-    PODVector<RayQueryResult> results;
-    RayOctreeQuery query(results, cameraRay, RAY_TRIANGLE, 1000.0f, DRAWABLE_GEOMETRY);
-    MC->world_.scene_->GetComponent<Octree>()->Raycast(query);
-
-    for (RayQueryResult r : results){
-
-            if (r.node_->HasTag("Table")){
-                return true;
-            }
-    }
-    return false;
+    return PickMouse().table_;
 }
 Ray InputMaster::MouseRay()
 {
@@ -728,7 +736,7 @@ Ray InputMaster::MouseRay()
 }
 void InputMaster::UpdateMousePos()
 {
-    IntVector2 mousePos{INPUT->GetMousePosition()};
+    IntVector2 mousePos{session_->GetMousePosition()};
     mousePos_.x_ = Clamp(static_cast<float>(mousePos.x_) / GRAPHICS->GetWidth(), 0.0f, 1.0f);
     mousePos_.y_ = Clamp(static_cast<float>(mousePos.y_) / GRAPHICS->GetHeight(), 0.0f, 1.0f);
 }
@@ -20,9 +20,11 @@
 #define INPUTMASTER_H
 
 #include "master.h"
+#include "pickmaster.h"
 
 #define VOLUME_STEP 0.1f
 #define IDLE_THRESHOLD 5.0f
+#define IDLE_ORBIT_TIME 120.0f
 #define STEP_INTERVAL 0.23f
 #define DEADZONE 0.34f
 #define MOUSESPEED 0.23f
@@ -31,6 +33,7 @@
 
 class Square;
 class Yad;
+class SessionMaster;
 
 class InputMaster : public Master
 {
@@ -38,6 +41,7 @@ class InputMaster : public Master
 public:
     InputMaster(Context* context);
     bool IsIdle() const noexcept { return idle_; }
+    bool IsCameraMoving() const { return smoothCamRotate_.Length() > 0.001f || Abs(smoothCamZoom_) > 0.001f; }
     void ConstructYad();
 
 private:
@@ -58,13 +62,16 @@ private:
     Vector2 smoothCamRotate_;
     float smoothCamZoom_;
 
+    SessionMaster* session_;
     Yad* yad_;
     Piece* rayPiece_;
     Square* raySquare_;
+    MousePick pick_;
 
     void ResetIdle();
     void SetIdle();
     Ray MouseRay();
+    const MousePick& PickMouse();
 
     Piece* RaycastToPiece();
     Square* RaycastToSquare();
@@ -85,7 +92,7 @@ private:
     void HandleMouseButtonUp(StringHash eventType, VariantMap &eventData);
     void HandleMouseWheel(StringHash eventType, VariantMap& eventData);
 
-    JoystickState* GetActiveJoystick();
+    int GetActiveJoystick();
     void HandleJoystickButtonDown(StringHash eventType, VariantMap &eventData);
     void HandleJoystickButtonUp(StringHash eventType, VariantMap &eventData);
     void HandleJoystickButtons();
@@ -0,0 +1,96 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "lightmaster.h"
+
+LightMaster::LightMaster(Context* context) : Master(context),
+    lights_{},
+    ranked_{},
+    pixelLightBudget_{PIXEL_LIGHT_BUDGET},
+    numEnabled_{0},
+    numPerPixel_{0}
+{
+    SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(LightMaster, HandlePostUpdate));
+}
+
+void LightMaster::Register(Light* light, float importance)
+{
+    ManagedLight managed{};
+    managed.light_ = light;
+    managed.importance_ = importance;
+    managed.active_ = true;
+
+    lights_.Push(managed);
+}
+//Replaces Light::SetEnabled for registered lights
+void LightMaster::SetActive(Light* light, bool active)
+{
+    for (ManagedLight& managed : lights_)
+        if (managed.light_.Get() == light){
+
+            managed.active_ = active;
+            if (!active)
+                light->SetEnabled(false);
+
+            return;
+        }
+}
+
+//Runs after the scene update, when this frame's fades have been applied
+void LightMaster::HandlePostUpdate(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    URHO3D_PROFILE(LightBudget);
+
+    ranked_.Clear();
+
+    for (ManagedLight& managed : lights_){
+
+        Light* light{managed.light_};
+        if (!light)
+            continue;
+
+        bool visible{managed.active_ && light->GetBrightness() > LIGHT_THRESHOLD};
+        if (light->IsEnabled() != visible)
+            light->SetEnabled(visible);
+
+        if (visible){
+            managed.score_ = managed.importance_ * light->GetBrightness();
+            ranked_.Push(&managed);
+        }
+    }
+
+    Sort(ranked_.Begin(), ranked_.End(), CompareScore);
+
+    numEnabled_ = ranked_.Size();
+    numPerPixel_ = 0;
+    for (ManagedLight* managed : ranked_){
+
+        Light* light{managed->light_};
+        //Shadows and directional lights need per-pixel lighting
+        bool perVertex{numPerPixel_ >= pixelLightBudget_
+                    && !light->GetCastShadows()
+                    && light->GetLightType() == LIGHT_POINT};
+
+        if (light->GetPerVertex() != perVertex)
+            light->SetPerVertex(perVertex);
+
+        if (!perVertex)
+            ++numPerPixel_;
+    }
+}
@@ -0,0 +1,63 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef LIGHTMASTER_H
+#define LIGHTMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include "master.h"
+
+//Dimmer lights than this are left out of rendering altogether
+#define LIGHT_THRESHOLD 0.025f
+#define PIXEL_LIGHT_BUDGET 6
+
+//Keeps every game light out of the renderer while it contributes nothing,
+//and moves the least important visible lights to per-vertex lighting.
+class LightMaster : public Master
+{
+    URHO3D_OBJECT(LightMaster, Master);
+public:
+    LightMaster(Context* context);
+
+    void Register(Light* light, float importance);
+    void SetActive(Light* light, bool active);
+    void SetPixelLightBudget(unsigned budget) { pixelLightBudget_ = budget; }
+
+    unsigned GetNumLights() const { return lights_.Size(); }
+    unsigned GetNumEnabled() const { return numEnabled_; }
+    unsigned GetNumPerPixel() const { return numPerPixel_; }
+private:
+    struct ManagedLight
+    {
+        WeakPtr<Light> light_;
+        float importance_;
+        float score_;
+        bool active_;
+    };
+
+    Vector<ManagedLight> lights_;
+    PODVector<ManagedLight*> ranked_;
+    unsigned pixelLightBudget_;
+    unsigned numEnabled_;
+    unsigned numPerPixel_;
+
+    static bool CompareScore(const ManagedLight* lhs, const ManagedLight* rhs) { return lhs->score_ > rhs->score_; }
+    void HandlePostUpdate(StringHash eventType, VariantMap& eventData);
+};
+
+#endif // LIGHTMASTER_H
@@ -26,6 +26,7 @@
 #include <Urho3D/Container/HashMap.h>
 #include <Urho3D/Container/Vector.h>
 #include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Profiler.h>
 #include <Urho3D/Engine/Application.h>
 #include <Urho3D/Engine/Console.h>
 #include <Urho3D/Engine/DebugHud.h>
@@ -71,6 +72,7 @@
 #include <Urho3D/Scene/Node.h>
 #include <Urho3D/Scene/SceneEvents.h>
 #include <Urho3D/Scene/Scene.h>
+#include <Urho3D/UI/BorderImage.h>
 #include <Urho3D/UI/Font.h>
 #include <Urho3D/UI/Text.h>
 #include <Urho3D/UI/UI.h>
@@ -19,15 +19,52 @@
 #include "mastercontrol.h"
 #include "inputmaster.h"
 #include "effectmaster.h"
+#include "lightmaster.h"
+#include "shadowmaster.h"
+#include "qualitymaster.h"
+#include "ecomaster.h"
 #include "quattercam.h"
 #include "piece.h"
 #include "board.h"
 #include "square.h"
 #include "indicator.h"
 #include "yad.h"
+#include "glowmodel.h"
+#include "savemaster.h"
+#include "cookedrouter.h"
+#include "benchmaster.h"
+#include "hudmaster.h"
+#include "shadermaster.h"
+#include "capturemaster.h"
+#include "replaymaster.h"
+#include "pickmaster.h"
+#include "sessionmaster.h"
 
 URHO3D_DEFINE_APPLICATION_MAIN(MasterControl);
 
+namespace {
+const char* materialNames[MAT_ALL]{"Board", "Glow", "GlowPulse", "Invisible", "LeafyKnoll", "Table", "Wood_dark", "Wood_light"};
+const char* modelNames[MDL_PIECE]{"Arrow", "BlockIndicator", "Board", "Plane", "Slot", "Sphere", "Table", "Yad"};
+const char* textureNames[TEX_ALL]{"LeafyMask"};
+const char* musicNames[2]{"Angelight - The Knowledge River", "Cao Sao Vang - Days Of Yore"};
+
+String MaterialFile(int material) { return "Materials/" + String(materialNames[material]) + ".xml"; }
+String TextureFile(int texture) { return "Textures/" + String(textureNames[texture]) + ".png"; }
+//Same codons as Piece::GetCodon
+String ModelFile(int model)
+{
+    if (model < MDL_PIECE)
+        return "Models/" + String(modelNames[model]) + ".mdl";
+
+    int piece{model < MDL_OUTLINE ? model - MDL_PIECE : model - MDL_OUTLINE};
+    String codon{String(piece & 1 ? "T" : "S") + (piece & 2 ? "R" : "S")};
+    if (model < MDL_OUTLINE)
+        return "Models/Piece_" + codon + (piece & 4 ? "H" : "S") + ".mdl";
+    else
+        return "Models/Piece_" + codon + "_outline.mdl";
+}
+}
+
 MasterControl* MasterControl::instance_ = NULL;
 
 MasterControl* MasterControl::GetInstance()
@@ -37,6 +74,11 @@ MasterControl* MasterControl::GetInstance()
 
 MasterControl::MasterControl(Context *context):
     Application(context),
+    benchmark_{false},
+    replay_{false},
+    recordInput_{false},
+    playInput_{false},
+    sessionSeed_{0},
     musicGain_{1.0f},
     gameState_{GameState::PLAYER1PICKS},
     previousGameState_{},
@@ -47,7 +89,12 @@ MasterControl::MasterControl(Context *context):
     selectedPiece_{},
     lastSelectedPiece_{},
     pickedPiece_{},
-    lastReset_{0.0f}
+    recording_{},
+    recordingMoves_{false},
+    recordingSaved_{false},
+    lastReset_{0.0f},
+    preloadTotal_{0},
+    finishBackgroundMs_{0}
 {
     instance_ = this;
 
@@ -57,35 +104,106 @@ MasterControl::MasterControl(Context *context):
     Square::RegisterObject(context_);
     Indicator::RegisterObject(context_);
     Yad::RegisterObject(context_);
+    GlowModel::RegisterObject(context_);
 }
 
 void MasterControl::Setup()
 {
-    SetRandomSeed(TIME->GetSystemTime());
+    const Vector<String>& arguments{GetArguments()};
+    benchmark_ = BenchMaster::IsRequested(arguments);
+    replay_ = ReplayMaster::IsRequested(arguments);
+    recordInput_ = SessionMaster::IsRecordRequested(arguments);
+
+    //A fixed seed reproduces every game of the session
+    unsigned seed{benchmark_ ? BENCH_SEED : TIME->GetSystemTime()};
+    for (unsigned a{0}; a + 1 < arguments.Size(); ++a)
+        if (arguments[a].ToLower() == "-seed")
+            seed = ToUInt(arguments[a + 1]);
+
+    //Played back input sessions start from the seed and window they were recorded with
+    String sessionFile{SessionMaster::GetPlayFile(arguments)};
+    SessionHeader session{};
+    playInput_ = !sessionFile.Empty();
+    if (playInput_ && SessionMaster::LoadHeader(context_, sessionFile, session))
+        seed = session.seed_;
+
+    sessionSeed_ = seed;
+    sessionRandom_.Seed(seed);
+    SetRandomSeed(seed);
 
     engineParameters_["LogName"] = FILES->GetAppPreferencesDir("urho3d", "logs")+"Quatter.log";
     engineParameters_["WindowTitle"] = "Quatter";
     engineParameters_["WindowIcon"] = "icon.png";
 
-    //Add resource paths
-    String resourcePaths{};
+    //A package written by quatter-cook holds every resource folder in one file
+    String package{};
+    for (const String& candidate : {FILES->GetAppPreferencesDir("luckey", "quatter") + RESOURCE_PACKAGE,
+                                    FILES->GetCurrentDir() + RESOURCE_PACKAGE})
+        if (FILES->FileExists(candidate)){
 
-    if (FILES->DirExists(FILES->GetAppPreferencesDir("luckey", "quatter")))
-        resourcePaths = FILES->GetAppPreferencesDir("luckey", "quatter");
-    else if (FILES->DirExists("Resources"))
-        resourcePaths = "Resources";
-    else if (FILES->DirExists("../Quatter/Resources"))
-        resourcePaths = "../Quatter/Resources";
+            package = candidate;
+            break;
+        }
 
-    resourceFolder_ = resourcePaths;
-    resourcePaths += ";";
+    if (!package.Empty()){
 
-    if (FILES->DirExists("Data"))
-        resourcePaths += "Data;";
-    if (FILES->DirExists("CoreData"))
-        resourcePaths += "CoreData;";
+        resourceFolder_ = GetPath(package);
+        engineParameters_[EP_RESOURCE_PREFIX_PATHS] = resourceFolder_;
+        engineParameters_[EP_RESOURCE_PACKAGES] = GetFileNameAndExtension(package);
+        engineParameters_[EP_RESOURCE_PATHS] = String::EMPTY;
 
-    engineParameters_[EP_RESOURCE_PATHS] = resourcePaths;
+    } else {
+        //Add resource paths
+        String resourcePaths{};
+
+        if (FILES->DirExists(FILES->GetAppPreferencesDir("luckey", "quatter")))
+            resourcePaths = FILES->GetAppPreferencesDir("luckey", "quatter");
+        else if (FILES->DirExists("Resources"))
+            resourcePaths = "Resources";
+        else if (FILES->DirExists("../Quatter/Resources"))
+            resourcePaths = "../Quatter/Resources";
+
+        resourceFolder_ = resourcePaths;
+        //Resources prepared by quatter-cook take precedence over their sources
+        if (!resourcePaths.Empty() && FILES->DirExists(AddTrailingSlash(resourcePaths) + "Cooked"))
+            resourcePaths = AddTrailingSlash(resourcePaths) + "Cooked;" + resourcePaths;
+        resourcePaths += ";";
+
+        if (FILES->DirExists("Data"))
+            resourcePaths += "Data;";
+        if (FILES->DirExists("CoreData"))
+            resourcePaths += "CoreData;";
+
+        engineParameters_[EP_RESOURCE_PATHS] = resourcePaths;
+    }
+
+    //Same window and unthrottled frames on every benchmark run
+    if (benchmark_){
+        engineParameters_[EP_FULL_SCREEN] = false;
+        engineParameters_[EP_WINDOW_WIDTH] = 1280;
+        engineParameters_[EP_WINDOW_HEIGHT] = 720;
+        engineParameters_[EP_VSYNC] = false;
+        engineParameters_[EP_FRAME_LIMITER] = false;
+        engineParameters_[EP_SOUND] = false;
+    }
+    //Replays render offscreen as fast as they can, the window only has to exist
+    if (replay_){
+        engineParameters_[EP_FULL_SCREEN] = false;
+        engineParameters_[EP_WINDOW_WIDTH] = 320;
+        engineParameters_[EP_WINDOW_HEIGHT] = 180;
+        engineParameters_[EP_VSYNC] = false;
+        engineParameters_[EP_FRAME_LIMITER] = false;
+        engineParameters_[EP_SOUND] = false;
+    }
+    //Played back input needs the window it was recorded in, not the time it took
+    if (playInput_ && session.width_ && session.height_){
+        engineParameters_[EP_FULL_SCREEN] = false;
+        engineParameters_[EP_WINDOW_WIDTH] = session.width_;
+        engineParameters_[EP_WINDOW_HEIGHT] = session.height_;
+        engineParameters_[EP_VSYNC] = false;
+        engineParameters_[EP_FRAME_LIMITER] = false;
+        engineParameters_[EP_SOUND] = false;
+    }
 
     //    engineParameters_["FullScreen"] = false;
     //    engineParameters_["WindowWidth"] = 1280;
@@ -94,28 +212,204 @@ void MasterControl::Setup()
 }
 void MasterControl::Start()
 {
-    context_->RegisterSubsystem(new InputMaster(context_));
-    context_->RegisterSubsystem(new EffectMaster(context_));
+    CACHE->AddResourceRouter(new CookedRouter(context_));
 
+    //Glow colors ride along in the instancing buffer, so even single glows are instanced
+    Renderer* renderer{GetSubsystem<Renderer>()};
+    renderer->SetNumExtraInstancingBufferElements(1);
+    renderer->SetMinInstances(1);
+    GlowModel::SetInstancing(GRAPHICS->GetInstancingSupport() && renderer->GetDynamicInstancing());
 
-    CreateScene();
+    CreateLoadingScreen();
+    Preload();
 
+    //Closing the window goes through Exit, so captures finish while there is a context
+    engine_->SetAutoExit(false);
+    SubscribeToEvent(E_EXITREQUESTED, URHO3D_HANDLER(MasterControl, HandleExitRequested));
     SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(MasterControl, HandleUpdate));
 }
+//Everything the scene is built from, read and decoded on worker threads
+void MasterControl::Preload()
+{
+    ResourceCache* cache{CACHE};
+    //Leave more of each frame to finishing resources while nothing else runs
+    finishBackgroundMs_ = cache->GetFinishBackgroundResourcesMs();
+    cache->SetFinishBackgroundResourcesMs(PRELOAD_FINISH_MS);
+
+    for (int m{0}; m < MAT_ALL; ++m)
+        cache->BackgroundLoadResource<Material>(MaterialFile(m));
+    for (int m{0}; m < MDL_ALL; ++m)
+        cache->BackgroundLoadResource<Model>(ModelFile(m));
+    for (int t{0}; t < TEX_ALL; ++t)
+        cache->BackgroundLoadResource<Texture2D>(TextureFile(t));
+    for (const char* song : musicNames)
+        cache->BackgroundLoadResource<Sound>("Music/" + String(song) + ".ogg");
+
+    for (const char* renderPath : {"Forward", "Prepass", "Deferred"})
+        cache->BackgroundLoadResource<XMLFile>("RenderPaths/" + String(renderPath) + ".xml");
+    for (const char* postProcess : {"FXAA3", "BloomLow", "BloomMedium", "BloomHDR"})
+        cache->BackgroundLoadResource<XMLFile>("PostProcess/" + String(postProcess) + ".xml");
+
+    preloadTotal_ = cache->GetNumBackgroundLoadResources();
+}
+void MasterControl::CreateLoadingScreen()
+{
+    loadingScreen_ = GetSubsystem<UI>()->GetRoot()->CreateChild<BorderImage>();
+    loadingScreen_->SetAlignment(HA_CENTER, VA_CENTER);
+    loadingScreen_->SetSize(LOADING_BAR_WIDTH, LOADING_BAR_HEIGHT);
+    loadingScreen_->SetColor(Color(1.0f, 1.0f, 1.0f, 0.05f));
+
+    loadingBar_ = loadingScreen_->CreateChild<BorderImage>();
+    loadingBar_->SetSize(0, LOADING_BAR_HEIGHT);
+    loadingBar_->SetColor(Color(0.125f, 1.0f, 0.666f, 0.5f));
+}
+//Builds the scene once the last preloaded resource is resident
+void MasterControl::UpdateLoading()
+{
+    unsigned pending{CACHE->GetNumBackgroundLoadResources()};
+    //Materials add their textures and techniques while they load
+    preloadTotal_ = Max(preloadTotal_, pending);
+    float progress{preloadTotal_ ? 1.0f - static_cast<float>(pending) / preloadTotal_ : 1.0f};
+    loadingBar_->SetWidth(Max(loadingBar_->GetWidth(), RoundToInt(progress * LOADING_BAR_WIDTH)));
+
+    if (pending)
+        return;
+
+    loadingScreen_->Remove();
+    loadingScreen_.Reset();
+    loadingBar_.Reset();
+    CACHE->SetFinishBackgroundResourcesMs(finishBackgroundMs_);
+
+    Launch();
+}
+void MasterControl::Launch()
+{
+    //Compile shaders before anything draws with them
+    context_->RegisterSubsystem(new ShaderMaster(context_));
+    GetSubsystem<ShaderMaster>()->Precache();
+
+    context_->RegisterSubsystem(new SessionMaster(context_));
+    context_->RegisterSubsystem(new InputMaster(context_));
+    context_->RegisterSubsystem(new PickMaster(context_));
+    context_->RegisterSubsystem(new EffectMaster(context_));
+    context_->RegisterSubsystem(new LightMaster(context_));
+    context_->RegisterSubsystem(new ShadowMaster(context_));
+    context_->RegisterSubsystem(new QualityMaster(context_));
+    context_->RegisterSubsystem(new EcoMaster(context_));
+    context_->RegisterSubsystem(new SaveMaster(context_));
+    context_->RegisterSubsystem(new HudMaster(context_));
+    context_->RegisterSubsystem(new CaptureMaster(context_));
+    if (benchmark_)
+        context_->RegisterSubsystem(new BenchMaster(context_));
+    if (replay_)
+        context_->RegisterSubsystem(new ReplayMaster(context_));
+
+    LoadResources();
+    CreateScene();
+
+    //Resume where the last session left off, unless its input is recorded or played back
+    Snapshot snapshot{};
+    if (!benchmark_ && !replay_ && !recordInput_ && !playInput_ && GetSubsystem<SaveMaster>()->Load(snapshot)){
+
+        ApplySnapshot(snapshot);
+        history_.Clear(snapshot.position_);
+        //Only games followed from the empty board can be replayed
+        if (snapshot.position_.IsEmpty())
+            StartRecording();
+        else
+            recordingMoves_ = false;
+    }
+    if (benchmark_)
+        GetSubsystem<BenchMaster>()->Start();
+    if (replay_)
+        GetSubsystem<ReplayMaster>()->Start();
+    GetSubsystem<SessionMaster>()->Start();
+}
 void MasterControl::Stop()
 {
+    //Quitting while still loading leaves nothing to save
+    SaveMaster* saveMaster{GetSubsystem<SaveMaster>()};
+    if (saveMaster)
+        saveMaster->Flush();
+    CaptureMaster* captureMaster{GetSubsystem<CaptureMaster>()};
+    if (captureMaster)
+        captureMaster->Stop();
+    ShaderMaster* shaderMaster{GetSubsystem<ShaderMaster>()};
+    if (shaderMaster)
+        shaderMaster->Save();
+    SessionMaster* sessionMaster{GetSubsystem<SessionMaster>()};
+    if (sessionMaster)
+        sessionMaster->Stop();
     engine_->DumpResources(true);
 }
 void MasterControl::Exit()
 {
-//    File file(context_, "Resources/Endgame.xml", FILE_WRITE);
-//    world_.scene_->SaveXML(file);
+    SaveSnapshot();
+    GetSubsystem<CaptureMaster>()->Finish();
 
     engine_->Exit();
 }
+void MasterControl::HandleExitRequested(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    //Quitting while still loading leaves nothing to save or capture
+    if (!world_.scene_)
+        engine_->Exit();
+    else
+        Exit();
+}
+
+void MasterControl::LoadResources()
+{
+    for (int m{0}; m < MAT_ALL; ++m)
+        materials_[m] = CACHE->GetResource<Material>(MaterialFile(m));
+    for (int m{0}; m < MDL_ALL; ++m)
+        models_[m] = CACHE->GetResource<Model>(ModelFile(m));
+    for (int t{0}; t < TEX_ALL; ++t)
+        textures_[t] = CACHE->GetResource<Texture2D>(TextureFile(t));
+
+    if (materials_[MAT_GLOW])
+        glowColor_ = materials_[MAT_GLOW]->GetShaderParameter("GlowColor").GetColor();
+}
+//Lookups by name are left for resources missing from the table
+Material* MasterControl::GetMaterial(String name) const
+{
+    for (int m{0}; m < MAT_ALL; ++m)
+        if (name == materialNames[m])
+            return materials_[m];
+
+    Log::Write(LOG_WARNING, "Material " + name + " is not in the resource table");
+    return CACHE->GetResource<Material>("Materials/" + name + ".xml");
+}
+Model* MasterControl::GetModel(String name) const
+{
+    String fileName{"Models/" + name + ".mdl"};
+    for (int m{0}; m < MDL_ALL; ++m)
+        if (models_[m] && models_[m]->GetName() == fileName)
+            return models_[m];
+
+    Log::Write(LOG_WARNING, "Model " + name + " is not in the resource table");
+    return CACHE->GetResource<Model>(fileName);
+}
+Texture* MasterControl::GetTexture(String name) const
+{
+    for (int t{0}; t < TEX_ALL; ++t)
+        if (name == textureNames[t])
+            return textures_[t];
+
+    Log::Write(LOG_WARNING, "Texture " + name + " is not in the resource table");
+    return CACHE->GetResource<Texture2D>("Textures/" + name + ".png");
+}
 
 void MasterControl::CreateScene()
 {
+    //A replay starts from the layout of the game it shows
+    ReplayMaster* replayMaster{GetSubsystem<ReplayMaster>()};
+    if (replayMaster && replayMaster->IsLoaded())
+        random_.Seed(replayMaster->GetSeed());
+    else
+        NewGameSeed();
+
     world_.scene_ = new Scene(context_);
     world_.scene_->CreateComponent<Octree>();
 
@@ -130,6 +424,13 @@ void MasterControl::CreateScene()
     CreateBoardAndPieces();
 
     GetSubsystem<InputMaster>()->ConstructYad();
+    GetSubsystem<PickMaster>()->Build();
+    GetSubsystem<ShadowMaster>()->Bake();
+    world_.camera_->SelectRenderPath();
+    GetSubsystem<QualityMaster>()->Init();
+
+    history_.Clear(GetPosition());
+    StartRecording();
 }
 void MasterControl::CreateLights()
 {
@@ -141,7 +442,8 @@ void MasterControl::CreateLights()
     leafyLight_->SetLightType(LIGHT_SPOT);
     leafyLight_->SetRange(180.0f);
     leafyLight_->SetFov(34.0f);
-    leafyLight_->SetShapeTexture(static_cast<Texture*>(CACHE->GetResource<Texture2D>("Textures/LeafyMask.png")));
+    leafyLight_->SetShapeTexture(GetTexture(TEX_LEAFY_MASK));
+    LIGHTS->Register(leafyLight_, 4.0f);
 
     //Add a directional light to the world. Enable cascaded shadows on it
     Node* downardsLightNode{world_.scene_->CreateChild("DirectionalLight")};
@@ -154,6 +456,7 @@ void MasterControl::CreateLights()
     downwardsLight->SetCastShadows(true);
     downwardsLight->SetShadowBias(BiasParameters(0.000025f, 0.5f));
     downwardsLight->SetShadowCascade(CascadeParameters(7.0f, 13.0f, 23.0f, 42.0f, 0.6));
+    LIGHTS->Register(downwardsLight, 4.0f);
 
     //Create point lights
     for (Vector3 pos : {Vector3(-10.0f, 8.0f, -23.0f), Vector3(-20.0f, -8.0f, 23.0f), Vector3(20.0f, -7.0f, 23.0f)}){
@@ -167,19 +470,20 @@ void MasterControl::CreateLights()
         pointLight->SetCastShadows(true);
         pointLight->SetShadowResolution(0.25f);
         pointLight->SetShadowIntensity(0.6f);
+        LIGHTS->Register(pointLight, 3.0f);
     }
 }
 void MasterControl::CreateSkybox()
 {
     Node* skyNode{world_.scene_->CreateChild("Sky")};
     Skybox* skybox{skyNode->CreateComponent<Skybox>()};
-    skybox->SetModel(GetModel("Sphere"));
-    skybox->SetMaterial(GetMaterial("LeafyKnoll"));
+    skybox->SetModel(GetModel(MDL_SPHERE));
+    skybox->SetMaterial(GetMaterial(MAT_LEAFY_KNOLL));
 }
 void MasterControl::CreateJukebox()
 {
-    Sound* song1{GetMusic("Angelight - The Knowledge River")};
-    Sound* song2{GetMusic("Cao Sao Vang - Days Of Yore")};
+    Sound* song1{GetMusic(musicNames[0])};
+    Sound* song2{GetMusic(musicNames[1])};
     Node* musicNode{world_.scene_->CreateChild("Music")};
 
     musicSource1_ = musicNode->CreateComponent<SoundSource>();
@@ -199,16 +503,16 @@ void MasterControl::CreateTable()
     tableNode->SetTags(tag);
     tableNode->SetRotation(Quaternion(23.5f, Vector3::UP));
     StaticModel* tableModel = tableNode->CreateComponent<StaticModel>();
-    tableModel->SetModel(GetModel("Table"));
-    tableModel->SetMaterial(GetMaterial("Table"));
+    tableModel->SetModel(GetModel(MDL_TABLE));
+    tableModel->SetMaterial(GetMaterial(MAT_TABLE));
     tableModel->GetMaterial()->SetShaderParameter("MatDiffColor", Vector4(0.32f, 0.40f, 0.42f, 1.0f));
     tableModel->SetCastShadows(true);
     Node* hitNode{world_.scene_->CreateChild("HitPlane")};
     hitNode->SetPosition(Vector3::DOWN * 1.23f);
     hitNode->SetScale(128.0f);
     StaticModel* hitPlane{hitNode->CreateComponent<StaticModel>()};
-    hitPlane->SetModel(MC->GetModel("Plane"));
-    hitPlane->SetMaterial(MC->GetMaterial("Invisible"));
+    hitPlane->SetModel(MC->GetModel(MDL_PLANE));
+    hitPlane->SetMaterial(MC->GetMaterial(MAT_INVISIBLE));
 }
 void MasterControl::CreateBoardAndPieces()
 {
@@ -222,10 +526,10 @@ void MasterControl::CreateBoardAndPieces()
         newPiece->Init(Piece::PieceAttributes(p));
 
         world_.pieces_.Push(SharedPtr<Piece>(newPiece));
+        float offsetX{random_.Float(0.05f)};
+        float offsetZ{random_.Float(0.05f)};
         newPiece->SetPosition(AttributesToPosition(newPiece->ToInt())
-                              + Vector3(Random(0.05f),
-                                        0.0f,
-                                        Random(0.05f)));
+                              + Vector3(offsetX, 0.0f, offsetZ));
     }
 }
 
@@ -243,6 +547,13 @@ Sound* MasterControl::GetSample(String name) const {
 void MasterControl::HandleUpdate(StringHash eventType, VariantMap& eventData)
 { (void)eventType; (void)eventData;
 
+    if (!world_.scene_){
+        UpdateLoading();
+        return;
+    }
+
+    URHO3D_PROFILE(GameUpdate);
+
     if (selectionMode_ == SM_CAMERA && !GetSubsystem<InputMaster>()->IsIdle())
         CameraSelectPiece();
 
@@ -351,16 +662,27 @@ void MasterControl::NextPhase()
             CameraSelectPiece();
     } break;
     }
+
+    Position position{GetPosition()};
+    RecordMove(position);
+    history_.Push(position);
+    SaveSnapshot();
 }
 void MasterControl::Quatter()
 {
     previousGameState_ = gameState_;
 
     gameState_ = GameState::QUATTER;
+
+    Position position{GetPosition()};
+    RecordMove(position);
+    history_.Push(position);
+    SaveSnapshot();
 }
 void MasterControl::Reset()
 {
     lastReset_ = TIME->GetElapsedTime();
+    NewGameSeed();
 
     for (Piece* p: world_.pieces_){
 
@@ -386,6 +708,199 @@ void MasterControl::Reset()
         }
     }
     startGameState_ = gameState_;
+
+    history_.Clear(GetPosition());
+    StartRecording();
+    SaveSnapshot();
+}
+
+Position MasterControl::GetPosition() const
+{
+    Position position{Position::Start()};
+    world_.board_->GetPosition(position);
+
+    if (pickedPiece_){
+        position.picked_ = pickedPiece_->ToInt();
+        position.free_ &= ~(1 << position.picked_);
+    }
+
+    GameState turn{gameState_ == GameState::QUATTER ? previousGameState_ : gameState_};
+    position.player_ = turn == GameState::PLAYER2PICKS || turn == GameState::PLAYER2PUTS;
+    position.quatter_ = position.FindQuatter();
+
+    return position;
+}
+Snapshot MasterControl::TakeSnapshot() const
+{
+    Snapshot snapshot{};
+    snapshot.position_ = GetPosition();
+    snapshot.gameState_ = static_cast<unsigned char>(gameState_);
+    snapshot.previousGameState_ = static_cast<unsigned char>(previousGameState_);
+    snapshot.startGameState_ = static_cast<unsigned char>(startGameState_);
+    snapshot.selectionMode_ = selectionMode_;
+    snapshot.musicState_ = musicState_;
+    snapshot.previousMusicState_ = previousMusicState_;
+    snapshot.musicGain_ = musicGain_;
+    snapshot.cameraYaw_ = CAMERA->GetYaw();
+    snapshot.cameraPitch_ = CAMERA->GetPitch();
+    snapshot.cameraDistance_ = CAMERA->aimDistance_;
+    snapshot.seed_ = random_.GetSeed();
+
+    return snapshot;
+}
+//Moves pieces and squares to match position, either at once or arching there
+void MasterControl::SetPosition(const Position& position, bool animate)
+{
+    DeselectPiece();
+    lastSelectedPiece_ = nullptr;
+    pickedPiece_ = nullptr;
+
+    for (Piece* piece: world_.pieces_){
+
+        int p{piece->ToInt()};
+        if (position.IsFree(p)){
+
+            Quaternion rotation{piece->GetNode()->GetWorldRotation().YawAngle(), Vector3::UP};
+            piece->Restore(PieceState::FREE, world_.scene_, AttributesToPosition(p), rotation, animate);
+
+        } else if (position.picked_ == p){
+
+            piece->Restore(PieceState::PICKED, CAMERA->GetPocket(position.player_ == 0),
+                           Vector3::DOWN, Quaternion(10.0f, Vector3(1.0f, 0.0f, 0.5f)), animate);
+            pickedPiece_ = piece;
+        }
+    }
+    world_.board_->Restore(position, animate);
+}
+//Puts everything in place at once, without any of the animations that led there
+void MasterControl::ApplySnapshot(const Snapshot& snapshot)
+{
+    SetPosition(snapshot.position_);
+
+    gameState_ = static_cast<GameState>(snapshot.gameState_);
+    previousGameState_ = static_cast<GameState>(snapshot.previousGameState_);
+    startGameState_ = static_cast<GameState>(snapshot.startGameState_);
+
+    musicState_ = static_cast<MusicState>(snapshot.musicState_);
+    previousMusicState_ = static_cast<MusicState>(snapshot.previousMusicState_);
+    musicGain_ = Clamp(snapshot.musicGain_, 0.0f, 1.0f);
+    musicSource1_->SetGain(musicState_ == MUSIC_SONG1 ? musicGain_ : 0.0f);
+    musicSource2_->SetGain(musicState_ == MUSIC_SONG2 ? musicGain_ : 0.0f);
+
+    CAMERA->SetView(snapshot.cameraYaw_, snapshot.cameraPitch_, snapshot.cameraDistance_);
+
+    selectionMode_ = static_cast<SelectionMode>(snapshot.selectionMode_);
+    if (selectionMode_ == SM_CAMERA && InPickState())
+        CameraSelectPiece(true);
+
+    random_.Seed(snapshot.seed_);
+    Log::Write(LOG_INFO, "Resumed game seed: " + String(random_.GetSeed()));
+}
+void MasterControl::SaveSnapshot()
+{
+    //Scripted games should not replace the one waiting to be resumed
+    if (benchmark_ || replay_ || playInput_)
+        return;
+
+    GetSubsystem<SaveMaster>()->Save(TakeSnapshot());
+}
+
+void MasterControl::Undo()
+{
+    if (!history_.CanUndo())
+        return;
+
+    StepThroughHistory(history_.Undo());
+}
+void MasterControl::Redo()
+{
+    if (!history_.CanRedo())
+        return;
+
+    StepThroughHistory(history_.Redo());
+}
+//Game state follows from the position, the player to move and a possible quatter
+void MasterControl::StepThroughHistory(const Position& position)
+{
+    SetPosition(position, true);
+
+    bool player2{position.player_ == 1};
+    GameState puts{player2 ? GameState::PLAYER2PUTS : GameState::PLAYER1PUTS};
+    GameState picks{player2 ? GameState::PLAYER2PICKS : GameState::PLAYER1PICKS};
+
+    if (position.quatter_ >= 0){
+        previousGameState_ = puts;
+        gameState_ = GameState::QUATTER;
+    } else if (position.picked_ != NO_PIECE){
+        previousGameState_ = player2 ? GameState::PLAYER1PICKS : GameState::PLAYER2PICKS;
+        gameState_ = puts;
+    } else {
+        previousGameState_ = player2 ? GameState::PLAYER1PUTS : GameState::PLAYER2PUTS;
+        gameState_ = picks;
+        if (selectionMode_ != SM_YAD)
+            CameraSelectPiece(true);
+    }
+
+    //Redoing to the end of a game finishes it as much as playing it
+    if (position.IsOver()){
+
+        recording_.numMoves_ = Min(history_.GetCursor(), static_cast<unsigned>(RECORDING_MOVES));
+        SaveRecording();
+    }
+
+    SaveSnapshot();
+}
+
+void MasterControl::StartRecording()
+{
+    recording_.seed_ = random_.GetSeed();
+    recording_.state_ = random_.GetState();
+    recording_.startGameState_ = static_cast<unsigned char>(gameState_);
+    recording_.numMoves_ = 0;
+    recordingMoves_ = true;
+    recordingSaved_ = false;
+}
+//Adds the move that leads from the current history entry to position,
+//replacing whatever undo left behind, and saves the game once it is over
+void MasterControl::RecordMove(const Position& position)
+{
+    if (!recordingMoves_)
+        return;
+
+    const Position& previous{history_.Current()};
+    recording_.numMoves_ = Min(history_.GetCursor(), static_cast<unsigned>(RECORDING_MOVES - 1));
+
+    RecordedMove& move{recording_.moves_[recording_.numMoves_++]};
+    move.time_ = TIME->GetElapsedTime() - lastReset_;
+    move.piece_ = position.picked_;
+    move.square_ = NO_PIECE;
+
+    if (previous.picked_ != NO_PIECE){
+
+        move.piece_ = previous.picked_;
+        for (int s{0}; s < POSITION_SQUARES; ++s)
+            if (previous.squares_[s] == NO_PIECE && position.squares_[s] != NO_PIECE)
+                move.square_ = static_cast<int8_t>(s);
+    }
+    recordingSaved_ = false;
+
+    if (position.IsOver())
+        SaveRecording();
+}
+//Once per finished game, and never for scripted ones
+void MasterControl::SaveRecording()
+{
+    if (!recordingMoves_ || recordingSaved_ || benchmark_ || replay_ || playInput_)
+        return;
+
+    GetSubsystem<SaveMaster>()->SaveRecording(recording_);
+    recordingSaved_ = true;
+}
+
+void MasterControl::NewGameSeed()
+{
+    random_.Seed(sessionRandom_.Fork());
+    Log::Write(LOG_INFO, "Game seed: " + String(random_.GetSeed()));
 }
 
 void MasterControl::NextSelectionMode()
@@ -466,17 +981,6 @@ void MasterControl::MusicGainDown(float step)
         FX->FadeTo(musicSource2_, musicGain_, 0.23f);
 }
 
-void MasterControl::TakeScreenshot()
-{
-    Image screenshot{context_};
-    GRAPHICS->TakeScreenShot(screenshot);
-    //Here we save in the Screenshots folder with date and time appended
-    String fileName{GetSubsystem<FileSystem>()->GetProgramDir() + "Screenshots/Screenshot_" +
-                Time::GetTimeStamp().Replaced(':', '_').Replaced('.', '_').Replaced(' ', '_')+".png"};
-    Log::Write(1, fileName);
-    screenshot.SavePNG(fileName);
-}
-
 float MasterControl::Sine(const float freq, const float min, const float max, const float shift)
 {
     float phase{freq * world_.scene_->GetElapsedTime() + shift};
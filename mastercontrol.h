@@ -21,6 +21,10 @@
 
 #include <Urho3D/Urho3D.h>
 #include "luckey.h"
+#include "randomstream.h"
+#include "position.h"
+#include "history.h"
+#include "recording.h"
 
 namespace Urho3D {
 class Node;
@@ -32,13 +36,22 @@ using namespace Urho3D;
 class QuatterCam;
 class InputMaster;
 class EffectMaster;
+class LightMaster;
 class Board;
 class Piece;
+struct Snapshot;
 
 enum class GameState{PLAYER1PICKS, PLAYER2PUTS, PLAYER2PICKS, PLAYER1PUTS, QUATTER};
 enum MusicState{MUSIC_SONG1, MUSIC_SONG2, MUSIC_OFF};
 enum SelectionMode{SM_CAMERA, SM_STEP, SM_YAD};
 
+//Resources the game uses, resolved once at startup
+enum MaterialId{MAT_BOARD, MAT_GLOW, MAT_GLOW_PULSE, MAT_INVISIBLE, MAT_LEAFY_KNOLL, MAT_TABLE, MAT_WOOD_DARK, MAT_WOOD_LIGHT, MAT_ALL};
+//Piece bodies follow MDL_PIECE in order of their first three attributes, outlines MDL_OUTLINE of the first two
+enum ModelId{MDL_ARROW, MDL_BLOCK_INDICATOR, MDL_BOARD, MDL_PLANE, MDL_SLOT, MDL_SPHERE, MDL_TABLE, MDL_YAD,
+             MDL_PIECE, MDL_OUTLINE = MDL_PIECE + 8, MDL_ALL = MDL_OUTLINE + 4};
+enum TextureId{TEX_LEAFY_MASK, TEX_ALL};
+
 typedef struct GameWorld
 {
     SharedPtr<QuatterCam> camera_;
@@ -54,22 +67,35 @@ typedef struct GameWorld
 
 #define MC MasterControl::GetInstance()
 #define FX GetSubsystem<EffectMaster>()
+#define LIGHTS GetSubsystem<LightMaster>()
 #define CAMERA MC->world_.camera_
 #define BOARD MC->world_.board_
 #define NUM_PIECES 16
 #define TABLE_DEPTH 0.21f
 #define RESET_DURATION 1.23f
 
-#define COLOR_GLOW MC->GetMaterial("Glow")->GetShaderParameter("MatDiffColor").GetColor()
+#define COLOR_GLOW MC->GetGlowColor()
+
+#define RESOURCE_PACKAGE "Quatter.pak"
+#define PRELOAD_FINISH_MS 20
+#define LOADING_BAR_WIDTH 230
+#define LOADING_BAR_HEIGHT 4
 
 class MasterControl : public Application
 {
     URHO3D_OBJECT(MasterControl, Application);
     friend class InputMaster;
+    friend class BenchMaster;
+    friend class ReplayMaster;
 public:
     MasterControl(Context* context);
     static MasterControl* GetInstance();
     String GetResourceFolder() const { return resourceFolder_; }
+    bool IsBenchmark() const { return benchmark_; }
+    bool IsReplay() const { return replay_; }
+    bool IsRecordingInput() const { return recordInput_; }
+    bool IsPlayingInput() const { return playInput_; }
+    unsigned GetSessionSeed() const { return sessionSeed_; }
 
     GameWorld world_;
 
@@ -91,7 +117,6 @@ public:
     void NextSelectionMode();
     void SetSelectionMode(SelectionMode mode);
     void NextMusicState();
-    void TakeScreenshot();
 
     float AttributesToAngle(int attributes) const { return (360.0f/NUM_PIECES * attributes) + 180.0f/NUM_PIECES + 23.5f; }
     Vector3 AttributesToPosition(int attributes) const {
@@ -99,23 +124,53 @@ public:
                 + Vector3::DOWN * TABLE_DEPTH;
     }
 
-    Material* GetMaterial(String name) const { return CACHE->GetResource<Material>("Materials/"+name+".xml"); }
-    Model* GetModel(String name) const { return CACHE->GetResource<Model>("Models/"+name+".mdl"); }
-    Texture* GetTexture(String name) const { return CACHE->GetResource<Texture>("Textures/"+name+".png"); }
+    Material* GetMaterial(MaterialId id) const { return materials_[id]; }
+    Model* GetModel(ModelId id) const { return models_[id]; }
+    Texture* GetTexture(TextureId id) const { return textures_[id]; }
+    Material* GetMaterial(String name) const;
+    Model* GetModel(String name) const;
+    Texture* GetTexture(String name) const;
+    const Color& GetGlowColor() const { return glowColor_; }
     Sound* GetMusic(String name) const;
     Sound* GetSample(String name) const;
 
+    RandomStream& GetRandom() { return random_; }
+    unsigned GetGameSeed() const { return random_.GetSeed(); }
+
     void Quatter();
     void SetPickedPiece(Piece* piece) { pickedPiece_ = piece; }
     Piece* GetSelectedPiece() const { return selectedPiece_; }
     Piece* GetPickedPiece() const { return pickedPiece_; }
     void DeselectPiece();
 
+    Position GetPosition() const;
+    void SetPosition(const Position& position, bool animate = false);
+    void Undo();
+    void Redo();
+    Snapshot TakeSnapshot() const;
+    void ApplySnapshot(const Snapshot& snapshot);
+    void SaveSnapshot();
+
     float Sine(const float freq, const float min = -1.0f, const float max = 1.0f, const float shift = 0.0f);
     float Cosine(const float freq, const float min = -1.0f, const float max = 1.0f, const float shift = 0.0f);
 private:
     static MasterControl* instance_;
     String resourceFolder_;
+    bool benchmark_;
+    bool replay_;
+    bool recordInput_;
+    bool playInput_;
+    unsigned sessionSeed_;
+
+    SharedPtr<Material> materials_[MAT_ALL];
+    SharedPtr<Model> models_[MDL_ALL];
+    SharedPtr<Texture> textures_[TEX_ALL];
+    Color glowColor_;
+
+    SharedPtr<BorderImage> loadingScreen_;
+    SharedPtr<BorderImage> loadingBar_;
+    unsigned preloadTotal_;
+    int finishBackgroundMs_;
 
     SharedPtr<Node> leafyLightNode_;
     SharedPtr<Light> leafyLight_;
@@ -135,9 +190,27 @@ private:
     Piece* lastSelectedPiece_;
     Piece* pickedPiece_;
 
+    RandomStream sessionRandom_;
+    RandomStream random_;
+    History history_;
+    Recording recording_;
+    bool recordingMoves_;
+    bool recordingSaved_;
+
+    void Preload();
+    void CreateLoadingScreen();
+    void UpdateLoading();
+    void Launch();
+    void LoadResources();
     void CreateScene();
     void Reset();
+    void NewGameSeed();
+    void StartRecording();
+    void RecordMove(const Position& position);
+    void SaveRecording();
+    void StepThroughHistory(const Position& position);
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleExitRequested(StringHash eventType, VariantMap& eventData);
 
     void CameraSelectPiece(bool force = false);
     void StepSelectPiece(bool next);
@@ -0,0 +1,198 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "pickmaster.h"
+#include "board.h"
+#include "piece.h"
+#include "square.h"
+
+PickMaster::PickMaster(Context* context) : Master(context),
+    capsules_{},
+    squares_{},
+    table_{},
+    board_{},
+    staticBounds_{},
+    squareHeight_{},
+    floorHeight_{},
+    floorRect_{},
+    built_{false}
+{
+}
+
+//Fits the proxies to the scene once it is complete
+void PickMaster::Build()
+{
+    Scene* scene{MC->world_.scene_};
+
+    for (Piece* piece : MC->world_.pieces_){
+
+        //Upright capsule as wide as the piece, its caps touching top and bottom
+        const BoundingBox& bounds{piece->GetNode()->GetComponent<StaticModel>()->GetBoundingBox()};
+        Vector3 center{bounds.Center()};
+        Capsule& capsule{capsules_[piece->ToInt()]};
+        capsule.piece_ = piece;
+        capsule.radius_ = 0.5f * Max(bounds.Size().x_, bounds.Size().z_);
+        capsule.bottom_ = Vector3(center.x_, Min(bounds.min_.y_ + capsule.radius_, center.y_), center.z_);
+        capsule.top_ = Vector3(center.x_, Max(bounds.max_.y_ - capsule.radius_, center.y_), center.z_);
+    }
+
+    //Two boxes under one bound make up the static part
+    staticBounds_.Clear();
+    FitBox(table_, scene->GetChild("Table"));
+    FitBox(board_, scene->GetChild("Board"));
+
+    squareHeight_ = BOARD->GetThickness();
+    for (int s{0}; s < POSITION_SQUARES; ++s)
+        squares_[s] = BOARD->GetSquare(s);
+
+    const BoundingBox& floor{scene->GetChild("HitPlane")->GetComponent<StaticModel>()->GetWorldBoundingBox()};
+    floorHeight_ = floor.max_.y_;
+    floorRect_ = Rect(floor.min_.x_, floor.min_.z_, floor.max_.x_, floor.max_.z_);
+
+    built_ = true;
+}
+
+void PickMaster::FitBox(Box& box, Node* node)
+{
+    StaticModel* model{node->GetComponent<StaticModel>()};
+    box.bounds_ = model->GetBoundingBox();
+    box.transform_ = node->GetWorldTransform();
+    box.inverse_ = box.transform_.Inverse();
+    staticBounds_.Merge(model->GetWorldBoundingBox());
+}
+
+//Fills in the nearest hit of every kind, leaving the cache fields of pick alone
+void PickMaster::Pick(const Ray& ray, MousePick& pick) const
+{
+    pick.piece_ = nullptr;
+    pick.square_ = nullptr;
+    pick.board_ = pick.table_ = pick.hit_ = pick.surface_ = false;
+    pick.surfacePosition_ = Vector3::ZERO;
+
+    if (!built_)
+        return;
+
+    //Pieces move, so their capsules follow the nodes
+    float pieceDistance{M_INFINITY};
+    for (const Capsule& capsule : capsules_){
+
+        if (!capsule.piece_ || !capsule.piece_->GetNode()->IsEnabled())
+            continue;
+
+        Node* node{capsule.piece_->GetNode()};
+        const Matrix3x4& transform{node->GetWorldTransform()};
+        Vector3 scale{transform.Scale()};
+        float distance{HitCapsule(ray, transform * capsule.bottom_, transform * capsule.top_,
+                                  capsule.radius_ * Max(scale.x_, Max(scale.y_, scale.z_)))};
+        if (distance < pieceDistance){
+
+            pieceDistance = distance;
+            pick.piece_ = capsule.piece_;
+        }
+    }
+
+    float surfaceDistance{HitFloor(ray)};
+    if (ray.HitDistance(staticBounds_) < M_INFINITY){
+
+        float tableDistance{HitBox(ray, table_)};
+        float boardDistance{HitBox(ray, board_)};
+        pick.table_ = tableDistance < M_INFINITY;
+        pick.board_ = boardDistance < M_INFINITY;
+        surfaceDistance = Min(surfaceDistance, Min(tableDistance, boardDistance));
+
+        HitSquare(ray, pick.square_);
+    }
+
+    if (surfaceDistance < M_INFINITY){
+
+        pick.surface_ = true;
+        pick.surfacePosition_ = ray.origin_ + ray.direction_ * surfaceDistance;
+    }
+    pick.hit_ = pick.surface_ || pick.piece_ || pick.square_;
+}
+
+//Nearest of the cylinder body and the two spheres capping it
+float PickMaster::HitCapsule(const Ray& ray, const Vector3& a, const Vector3& b, float radius)
+{
+    float distance{Min(ray.HitDistance(Sphere(a, radius)), ray.HitDistance(Sphere(b, radius)))};
+
+    Vector3 axis{b - a};
+    Vector3 offset{ray.origin_ - a};
+    float axisLength2{axis.DotProduct(axis)};
+    float axisDirection{axis.DotProduct(ray.direction_)};
+    float axisOffset{axis.DotProduct(offset)};
+
+    float qa{axisLength2 - axisDirection * axisDirection};
+    if (qa < M_EPSILON)
+        return distance;
+
+    float qb{axisLength2 * ray.direction_.DotProduct(offset) - axisOffset * axisDirection};
+    float qc{axisLength2 * offset.DotProduct(offset) - axisOffset * axisOffset - radius * radius * axisLength2};
+    float discriminant{qb * qb - qa * qc};
+    if (discriminant < 0.0f)
+        return distance;
+
+    float t{(-qb - sqrtf(discriminant)) / qa};
+    float along{axisOffset + t * axisDirection};
+    if (t >= 0.0f && along > 0.0f && along < axisLength2)
+        distance = Min(distance, t);
+
+    return distance;
+}
+
+//Tested in the space of the box and measured back in world space
+float PickMaster::HitBox(const Ray& ray, const Box& box) const
+{
+    Ray local{ray.Transformed(box.inverse_)};
+    float localDistance{local.HitDistance(box.bounds_)};
+    if (localDistance == M_INFINITY)
+        return M_INFINITY;
+
+    return (box.transform_ * (local.origin_ + local.direction_ * localDistance) - ray.origin_).Length();
+}
+
+//The squares share one plane, so where the ray crosses it gives the index
+float PickMaster::HitSquare(const Ray& ray, Square*& square) const
+{
+    Ray local{ray.Transformed(board_.inverse_)};
+    if (local.direction_.y_ >= 0.0f || local.origin_.y_ < squareHeight_)
+        return M_INFINITY;
+
+    Vector3 point{local.origin_ + local.direction_ * ((squareHeight_ - local.origin_.y_) / local.direction_.y_)};
+    int x{FloorToInt(point.x_ + BOARD_WIDTH / 2)};
+    int y{FloorToInt(point.z_ + BOARD_HEIGHT / 2)};
+    if (x < 0 || x >= BOARD_WIDTH || y < 0 || y >= BOARD_HEIGHT)
+        return M_INFINITY;
+
+    square = squares_[x + BOARD_WIDTH * y];
+    return (board_.transform_ * point - ray.origin_).Length();
+}
+
+//Invisible plane below the table that keeps the yad on screen
+float PickMaster::HitFloor(const Ray& ray) const
+{
+    if (ray.direction_.y_ >= 0.0f || ray.origin_.y_ < floorHeight_)
+        return M_INFINITY;
+
+    float distance{(floorHeight_ - ray.origin_.y_) / ray.direction_.y_};
+    Vector3 point{ray.origin_ + ray.direction_ * distance};
+    if (floorRect_.IsInside(Vector2(point.x_, point.z_)) == OUTSIDE)
+        return M_INFINITY;
+
+    return distance;
+}
@@ -0,0 +1,89 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef PICKMASTER_H
+#define PICKMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include "master.h"
+
+class Piece;
+class Square;
+
+//What lies under the cursor, first hit of every kind
+struct MousePick
+{
+    Ray ray_;
+    unsigned frame_;
+    Piece* piece_;
+    Square* square_;
+    bool board_;
+    bool table_;
+    bool hit_;
+    bool surface_;      //Something the yad can rest on
+    Vector3 surfacePosition_;
+};
+
+//Picks against a few simple shapes instead of the triangles of render meshes:
+//a capsule around every piece, boxes for the table and board under one shared
+//bound, the top of the board as a grid that gives the square index directly
+//and the invisible floor as a plane. Shapes are fitted once to the models and
+//follow the nodes of the pieces, so picking costs the same whatever the meshes
+//look like and never allocates.
+class PickMaster : public Master
+{
+    URHO3D_OBJECT(PickMaster, Master);
+public:
+    PickMaster(Context* context);
+
+    void Build();
+    void Pick(const Ray& ray, MousePick& pick) const;
+
+    static float HitCapsule(const Ray& ray, const Vector3& a, const Vector3& b, float radius);
+private:
+    struct Capsule
+    {
+        Piece* piece_;
+        Vector3 bottom_;    //Local to the piece
+        Vector3 top_;
+        float radius_;
+    };
+    struct Box
+    {
+        BoundingBox bounds_;
+        Matrix3x4 transform_;
+        Matrix3x4 inverse_;
+    };
+
+    Capsule capsules_[NUM_PIECES];
+    Square* squares_[POSITION_SQUARES];
+    Box table_;
+    Box board_;
+    BoundingBox staticBounds_;
+    float squareHeight_;
+    float floorHeight_;
+    Rect floorRect_;
+    bool built_;
+
+    void FitBox(Box& box, Node* node);
+    float HitBox(const Ray& ray, const Box& box) const;
+    float HitSquare(const Ray& ray, Square*& square) const;
+    float HitFloor(const Ray& ray) const;
+};
+
+#endif // PICKMASTER_H
@@ -20,6 +20,7 @@
 #include "effectmaster.h"
 #include "board.h"
 #include "piece.h"
+#include "lightmaster.h"
 
 void Piece::RegisterObject(Context *context)
 {
@@ -34,14 +35,14 @@ Piece::Piece(Context* context): LogicComponent(context),
 void Piece::OnNodeSet(Node* node)
 { (void)node;
 
-    node_->SetRotation(Quaternion(Random(360.0f), Vector3::UP));
+    node_->SetRotation(Quaternion(MC->GetRandom().Float(360.0f), Vector3::UP));
     StringVector tag{}; tag.Push(String("Piece"));
     node_->SetTags(tag);
 
     pieceModel_ = node_->CreateComponent<StaticModel>();
     pieceModel_->SetCastShadows(true);
 
-    outlineModel_ = node_->CreateComponent<StaticModel>();
+    outlineModel_ = node_->CreateComponent<GlowModel>();
     outlineModel_->SetCastShadows(false);
 
     Node* lightNode{node_->CreateChild("Light")};
@@ -50,6 +51,7 @@ void Piece::OnNodeSet(Node* node)
     light_->SetColor(Color(0.0f, 0.8f, 0.5f));
     light_->SetBrightness(0.0f);
     light_->SetRange(3.0f);
+    LIGHTS->Register(light_, 1.0f);
 }
 
 
@@ -57,15 +59,15 @@ void Piece::Init(PieceAttributes attributes)
 {
     attributes_ = attributes;
 
-    pieceModel_->SetModel(MC->GetModel("Piece_" + GetCodon(3)));
+    pieceModel_->SetModel(MC->GetModel(static_cast<ModelId>(MDL_PIECE + (ToInt() & 7))));
     if (attributes[3]){
-        pieceModel_->SetMaterial(MC->GetMaterial("Wood_light"));
+        pieceModel_->SetMaterial(MC->GetMaterial(MAT_WOOD_LIGHT));
     }
-    else pieceModel_->SetMaterial(MC->GetMaterial("Wood_dark"));
+    else pieceModel_->SetMaterial(MC->GetMaterial(MAT_WOOD_DARK));
 
-    outlineModel_->SetModel(MC->GetModel("Piece_"+GetCodon(2)+"_outline"));
-    outlineModel_->SetMaterial(MC->GetMaterial("Glow")->Clone());
-    outlineModel_->GetMaterial()->SetShaderParameter("MatDiffColor", Color(0.0f, 0.0f, 0.0f));
+    outlineModel_->SetModel(MC->GetModel(static_cast<ModelId>(MDL_OUTLINE + (ToInt() & 3))));
+    outlineModel_->SetMaterial(MC->GetMaterial(MAT_GLOW));
+    outlineModel_->SetColor(Color(0.0f, 0.0f, 0.0f));
     outlineModel_->SetEnabled(false);
 }
 
@@ -80,15 +82,42 @@ void Piece::Reset()
 
     if (state_ != PieceState::FREE){
         state_ = PieceState::FREE;
+        float angle{MC->GetRandom().Float(360.0f)};
+        float delay{MC->GetRandom().Float(0.42f)};
         FX->ArchTo(node_,
                    MC->AttributesToPosition(ToInt()),
-                   Quaternion(Random(360.0f), Vector3::UP),
-                   attributes_[0] ? 2.0f : 1.3f + attributes_[1] ? 0.5f : 1.0f + Random(0.23f),
+                   Quaternion(angle, Vector3::UP),
+                   attributes_[0] ? 2.0f : 1.3f + attributes_[1] ? 0.5f : 1.0f + MC->GetRandom().Float(0.23f),
                    RESET_DURATION,
-                   Random(0.42f) + 0.23f * (ToInt()/NUM_PIECES));
+                   delay + 0.23f * (ToInt()/NUM_PIECES));
     }
 }
 
+//Jumps straight to where an animation would have ended, or arches there when animated
+void Piece::Restore(PieceState state, Node* parent, Vector3 position, Quaternion rotation, bool animate)
+{
+    if (animate && state_ == state && node_->GetParent() == parent)
+        return;
+
+    node_->SetParent(parent);
+    if (animate){
+        FX->ArchTo(node_, position, rotation, 1.0f, 0.5f);
+    } else {
+        FX->Stop(node_);
+        node_->SetPosition(position);
+        node_->SetRotation(rotation);
+    }
+
+    state_ = state;
+
+    FX->Stop(outlineModel_);
+    outlineModel_->SetColor(Color(0.0f, 0.0f, 0.0f));
+    outlineModel_->SetEnabled(false);
+
+    FX->Stop(light_);
+    light_->SetBrightness(0.0f);
+}
+
 String Piece::GetCodon(int length) const
 {
     if (length > static_cast<int>(attributes_.size()) || length < 1)
@@ -115,7 +144,7 @@ void Piece::Select()
         outlineModel_->SetEnabled(true);
         if (state_ == PieceState::FREE){
             state_ = PieceState::SELECTED;
-            FX->FadeTo(outlineModel_->GetMaterial(),
+            FX->FadeTo(outlineModel_,
                                       COLOR_GLOW);
             FX->FadeTo(light_, 0.666f);
         }
@@ -126,7 +155,7 @@ void Piece::Deselect()
     if (state_ == PieceState::SELECTED){
 
         state_ = PieceState::FREE;
-        FX->FadeOut(outlineModel_->GetMaterial());
+        FX->FadeOut(outlineModel_);
         FX->FadeOut(light_);
     }
 }
@@ -143,7 +172,7 @@ void Piece::Pick()
 
         FX->ArchTo(node_, Vector3::DOWN, Quaternion(10.0f, Vector3(1.0f, 0.0f, 0.5f)), 1.0f, 0.8f);
 
-        FX->FadeOut(outlineModel_->GetMaterial());
+        FX->FadeOut(outlineModel_);
         FX->FadeOut(light_);
 
         MC->NextPhase();
@@ -156,6 +185,6 @@ void Piece::Put(Vector3 position)
         state_ = PieceState::PUT;
         MC->SetPickedPiece(nullptr);
         node_->SetParent(MC->world_.scene_);
-        FX->ArchTo(node_, position, Quaternion(Random(-13.0f, 13.0f), Vector3::UP), 2.3f, 0.5f);
+        FX->ArchTo(node_, position, Quaternion(MC->GetRandom().Float(-13.0f, 13.0f), Vector3::UP), 2.3f, 0.5f);
     }
 }
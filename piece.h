@@ -22,6 +22,7 @@
 #include <Urho3D/Urho3D.h>
 #include <bitset>
 #include "mastercontrol.h"
+#include "glowmodel.h"
 
 namespace Urho3D {
 class Node;
@@ -58,11 +59,12 @@ public:
     void Pick();
     void Put(Vector3 position);
     void Reset();
+    void Restore(PieceState state, Node* parent, Vector3 position, Quaternion rotation, bool animate = false);
 
     int ToInt() const { return static_cast<int>(attributes_.to_ulong()); }
 private:
     SharedPtr<StaticModel> pieceModel_;
-    SharedPtr<StaticModel> outlineModel_;
+    SharedPtr<GlowModel> outlineModel_;
     SharedPtr<Light> light_;
 
     PieceAttributes attributes_;
@@ -0,0 +1,379 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "player.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+void PinCurrentThread(const std::vector<int>& cpus)
+{
+#ifdef __linux__
+    if (cpus.empty())
+        return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+        CPU_SET(cpu, &set);
+
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpus;
+#endif
+}
+
+Player::Player(const std::string& name):
+    name_{name},
+    cpus_{}
+{
+}
+
+//Whole string as a decimal number, anything else is a bad configuration
+static bool ParseInt(const std::string& text, int& value)
+{
+    if (text.empty())
+        return false;
+
+    char* end{nullptr};
+    errno = 0;
+    long parsed{std::strtol(text.c_str(), &end, 10)};
+    if (*end != '\0' || errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX)
+        return false;
+
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+//Spec is "random", "greedy" or "search:depth=4,time=100,threads=2,name=deep"
+std::unique_ptr<Player> Player::Create(const std::string& spec)
+{
+    std::string type{spec.substr(0, spec.find(':'))};
+    std::string name{spec};
+    int depth{0};
+    int milliseconds{0};
+    int threads{1};
+
+    if (spec.find(':') != std::string::npos){
+
+        std::stringstream options{spec.substr(spec.find(':') + 1)};
+        std::string option{};
+        while (std::getline(options, option, ',')){
+
+            size_t equals{option.find('=')};
+            if (equals == std::string::npos)
+                return nullptr;
+
+            std::string key{option.substr(0, equals)};
+            std::string value{option.substr(equals + 1)};
+
+            if (key == "name")
+                name = value;
+            else if (key == "depth" && ParseInt(value, depth))
+                continue;
+            else if (key == "time" && ParseInt(value, milliseconds))
+                continue;
+            else if (key == "threads" && ParseInt(value, threads))
+                threads = std::max(1, threads);
+            else
+                return nullptr;
+        }
+    }
+
+    if (type == "random")
+        return std::unique_ptr<Player>(new RandomPlayer(name));
+    else if (type == "greedy")
+        return std::unique_ptr<Player>(new GreedyPlayer(name));
+    else if (type == "search")
+        return std::unique_ptr<Player>(new SearchPlayer(name, depth, milliseconds, threads));
+    else
+        return nullptr;
+}
+
+Move RandomPlayer::Play(const Position& position, RandomStream& random)
+{
+    Move move{-1, NO_PIECE};
+    Position after{position};
+
+    if (position.InPutState()){
+
+        std::vector<int> squares{};
+        for (int s{0}; s < POSITION_SQUARES; ++s)
+            if (position.squares_[s] == NO_PIECE)
+                squares.push_back(s);
+
+        move.square_ = squares[RandomIndex(random, static_cast<int>(squares.size()))];
+        after.Put(move.square_);
+    }
+
+    if (!after.IsOver()){
+
+        std::vector<int> pieces{};
+        for (int p{0}; p < POSITION_PIECES; ++p)
+            if (after.IsFree(p))
+                pieces.push_back(p);
+
+        move.piece_ = pieces[RandomIndex(random, static_cast<int>(pieces.size()))];
+    }
+    return move;
+}
+
+Move GreedyPlayer::Play(const Position& position, RandomStream& random)
+{
+    std::vector<Move> safe{};
+    std::vector<Move> losing{};
+
+    if (position.InPutState()){
+
+        for (int s{0}; s < POSITION_SQUARES; ++s){
+
+            if (position.squares_[s] != NO_PIECE)
+                continue;
+
+            Position after{position};
+            after.Put(s);
+            if (after.IsOver()){
+
+                if (after.quatter_ >= 0)
+                    return Move{s, NO_PIECE};
+
+                safe.push_back(Move{s, NO_PIECE});
+                continue;
+            }
+            for (int p{0}; p < POSITION_PIECES; ++p)
+                if (after.IsFree(p))
+                    (after.GivesQuatter(p) ? losing : safe).push_back(Move{s, p});
+        }
+    } else {
+
+        for (int p{0}; p < POSITION_PIECES; ++p)
+            if (position.IsFree(p))
+                (position.GivesQuatter(p) ? losing : safe).push_back(Move{-1, p});
+    }
+
+    std::vector<Move>& options{safe.empty() ? losing : safe};
+    return options[RandomIndex(random, static_cast<int>(options.size()))];
+}
+
+SearchPlayer::SearchPlayer(const std::string& name, int depth, int milliseconds, int threads): Player(name),
+    depth_{depth},
+    milliseconds_{milliseconds},
+    threads_{threads},
+    nodes_{0},
+    timed_{false},
+    abort_{false},
+    deadline_{}
+{
+    if (!depth_ && !milliseconds_)
+        depth_ = 2;
+}
+
+Move SearchPlayer::Play(const Position& position, RandomStream& random)
+{
+    std::vector<Move> moves{};
+
+    if (position.InPutState()){
+
+        for (int s{0}; s < POSITION_SQUARES; ++s){
+
+            if (position.squares_[s] != NO_PIECE)
+                continue;
+
+            Position after{position};
+            after.Put(s);
+            if (after.quatter_ >= 0)
+                return Move{s, NO_PIECE};
+            else if (after.IsFull()){
+                moves.push_back(Move{s, NO_PIECE});
+                continue;
+            }
+            for (int p{0}; p < POSITION_PIECES; ++p)
+                if (after.IsFree(p))
+                    moves.push_back(Move{s, p});
+        }
+    } else {
+
+        for (int p{0}; p < POSITION_PIECES; ++p)
+            if (position.IsFree(p))
+                moves.push_back(Move{-1, p});
+    }
+
+    if (moves.size() == 1)
+        return moves.front();
+
+    nodes_ = 0;
+    deadline_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds_);
+
+    std::vector<Move> best{moves};
+    int maxDepth{depth_ ? depth_ : POSITION_SQUARES};
+
+    for (int depth{1}; depth <= maxDepth; ++depth){
+
+        std::vector<int> scores(moves.size(), 0);
+        //The first iteration is never timed out
+        if (!SearchRoot(position, moves, depth, scores))
+            break;
+
+        int bestScore{*std::max_element(scores.begin(), scores.end())};
+        best.clear();
+        for (size_t m{0}; m < moves.size(); ++m)
+            if (scores[m] == bestScore)
+                best.push_back(moves[m]);
+
+        if (std::abs(bestScore) >= SCORE_DECISIVE
+         || depth >= position.NumFreeSquares()
+         || (milliseconds_ && std::chrono::steady_clock::now() > deadline_))
+            break;
+    }
+
+    return best[RandomIndex(random, static_cast<int>(best.size()))];
+}
+
+bool SearchPlayer::SearchRoot(const Position& position, const std::vector<Move>& moves, int depth, std::vector<int>& scores)
+{
+    std::atomic<size_t> next{0};
+    std::atomic<int> alpha{-SCORE_WIN};
+    std::atomic<unsigned long long> nodes{0};
+    timed_ = milliseconds_ && depth > 1;
+    abort_ = false;
+
+    auto work = [&](){
+
+        PinCurrentThread(cpus_);
+        unsigned long long threadNodes{0};
+
+        for (size_t m{next++}; m < moves.size(); m = next++){
+
+            //Search one below alpha so that equal moves get exact scores for the tie-break
+            int score{ScoreMove(position, moves[m], depth, alpha - 1, threadNodes)};
+            if (abort_)
+                break;
+
+            scores[m] = score;
+            int current{alpha};
+            while (score > current && !alpha.compare_exchange_weak(current, score));
+        }
+        nodes += threadNodes;
+    };
+
+    std::vector<std::thread> helpers{};
+    for (int t{1}; t < std::min(threads_, static_cast<int>(moves.size())); ++t)
+        helpers.push_back(std::thread(work));
+    work();
+    for (std::thread& helper : helpers)
+        helper.join();
+
+    nodes_ += nodes;
+
+    return !abort_;
+}
+
+int SearchPlayer::ScoreMove(const Position& position, Move move, int depth, int alpha, unsigned long long& nodes)
+{
+    Position after{position};
+
+    if (move.square_ >= 0){
+
+        after.Put(move.square_);
+        if (after.quatter_ >= 0)
+            return SCORE_WIN;
+        else if (after.IsFull())
+            return 0;
+    }
+
+    if (after.GivesQuatter(move.piece_))
+        return -(SCORE_WIN - 1);
+    else if (depth <= 1)
+        return 0;
+
+    after.Pick(move.piece_);
+    return -Search(after, depth - 1, -SCORE_WIN, -alpha, 1, nodes);
+}
+
+//Scores the position for the player that has to put the picked piece
+int SearchPlayer::Search(const Position& position, int depth, int alpha, int beta, int ply, unsigned long long& nodes)
+{
+    if ((++nodes & 0x3ff) == 0 && timed_ && std::chrono::steady_clock::now() > deadline_)
+        abort_ = true;
+    if (abort_)
+        return 0;
+
+    int picked{position.picked_};
+    int freeSquares{0};
+
+    for (int s{0}; s < POSITION_SQUARES; ++s){
+
+        if (position.squares_[s] != NO_PIECE)
+            continue;
+
+        if (position.WinningLine(s, picked) >= 0)
+            return SCORE_WIN - ply;
+
+        ++freeSquares;
+    }
+    //Last square and no win means a full board
+    if (freeSquares == 1)
+        return 0;
+
+    int best{-SCORE_WIN};
+
+    for (int s{0}; s < POSITION_SQUARES; ++s){
+
+        if (position.squares_[s] != NO_PIECE)
+            continue;
+
+        Position after{position};
+        after.squares_[s] = static_cast<int8_t>(picked);
+        after.picked_ = NO_PIECE;
+
+        for (int p{0}; p < POSITION_PIECES; ++p){
+
+            if (!after.IsFree(p))
+                continue;
+
+            int score{};
+            if (after.GivesQuatter(p)){
+                score = -(SCORE_WIN - ply - 1);
+            } else if (depth <= 1){
+                score = 0;
+            } else {
+                Position child{after};
+                child.Pick(p);
+                score = -Search(child, depth - 1, -beta, -alpha, ply + 1, nodes);
+            }
+
+            if (score > best){
+                best = score;
+                if (best > alpha)
+                    alpha = best;
+                if (alpha >= beta)
+                    return best;
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,99 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef PLAYER_H
+#define PLAYER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "position.h"
+#include "randomstream.h"
+
+#define SCORE_WIN 1000
+#define SCORE_DECISIVE (SCORE_WIN - 100)
+
+void PinCurrentThread(const std::vector<int>& cpus);
+
+//Put the picked piece on square (-1 on the opening pick) then hand piece to the opponent
+struct Move
+{
+    int square_;
+    int piece_;
+};
+
+class Player
+{
+public:
+    Player(const std::string& name);
+    virtual ~Player() {}
+    static std::unique_ptr<Player> Create(const std::string& spec);
+
+    const std::string& GetName() const noexcept { return name_; }
+    virtual int GetNumThreads() const noexcept { return 1; }
+    void SetCpus(const std::vector<int>& cpus) { cpus_ = cpus; }
+
+    virtual Move Play(const Position& position, RandomStream& random) = 0;
+protected:
+    std::string name_;
+    std::vector<int> cpus_;
+
+    static int RandomIndex(RandomStream& random, int size) { return random.Int(size); }
+};
+
+class RandomPlayer : public Player
+{
+public:
+    RandomPlayer(const std::string& name) : Player(name) {}
+    virtual Move Play(const Position& position, RandomStream& random);
+};
+
+//Takes a win when there is one and never hands over a piece that loses on the spot
+class GreedyPlayer : public Player
+{
+public:
+    GreedyPlayer(const std::string& name) : Player(name) {}
+    virtual Move Play(const Position& position, RandomStream& random);
+};
+
+//Iterative deepening alpha-beta with the root moves split over threads
+class SearchPlayer : public Player
+{
+public:
+    SearchPlayer(const std::string& name, int depth, int milliseconds, int threads);
+    virtual int GetNumThreads() const noexcept { return threads_; }
+    virtual Move Play(const Position& position, RandomStream& random);
+    unsigned long long GetNodes() const noexcept { return nodes_; }
+private:
+    int depth_;
+    int milliseconds_;
+    int threads_;
+    unsigned long long nodes_;
+    bool timed_;
+    std::atomic<bool> abort_;
+    std::chrono::steady_clock::time_point deadline_;
+
+    int Search(const Position& position, int depth, int alpha, int beta, int ply, unsigned long long& nodes);
+    int ScoreMove(const Position& position, Move move, int depth, int alpha, unsigned long long& nodes);
+    bool SearchRoot(const Position& position, const std::vector<Move>& moves, int depth, std::vector<int>& scores);
+};
+
+#endif // PLAYER_H
@@ -0,0 +1,235 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "position.h"
+
+//Same order as Board::CheckQuatter: rows, columns, diagonals, 2x2 blocks
+const int8_t Position::lines_[POSITION_LINES][4]{
+    { 0,  1,  2,  3}, { 4,  5,  6,  7}, { 8,  9, 10, 11}, {12, 13, 14, 15},
+    { 0,  4,  8, 12}, { 1,  5,  9, 13}, { 2,  6, 10, 14}, { 3,  7, 11, 15},
+    { 0,  5, 10, 15}, {12,  9,  6,  3},
+    { 0,  4,  1,  5}, { 4,  8,  5,  9}, { 8, 12,  9, 13},
+    { 1,  5,  2,  6}, { 5,  9,  6, 10}, { 9, 13, 10, 14},
+    { 2,  6,  3,  7}, { 6, 10,  7, 11}, {10, 14, 11, 15}
+};
+
+Position Position::Start()
+{
+    Position start{};
+    for (int s{0}; s < POSITION_SQUARES; ++s)
+        start.squares_[s] = NO_PIECE;
+
+    start.picked_ = NO_PIECE;
+    start.free_ = 0xffff;
+    start.player_ = 0;
+    start.quatter_ = -1;
+
+    return start;
+}
+
+bool Position::IsFull() const noexcept
+{
+    for (int8_t piece : squares_)
+        if (piece == NO_PIECE) return false;
+
+    return true;
+}
+bool Position::IsEmpty() const noexcept
+{
+    for (int8_t piece : squares_)
+        if (piece != NO_PIECE) return false;
+
+    return true;
+}
+//Every piece has to be in exactly one place
+bool Position::IsValid() const noexcept
+{
+    int found{free_};
+    for (int8_t piece : squares_){
+
+        if (piece == NO_PIECE)
+            continue;
+        else if (piece < 0 || piece >= POSITION_PIECES || (found >> piece) & 1)
+            return false;
+
+        found |= 1 << piece;
+    }
+    if (picked_ != NO_PIECE){
+
+        if (picked_ < 0 || picked_ >= POSITION_PIECES || (found >> picked_) & 1)
+            return false;
+
+        found |= 1 << picked_;
+    }
+    return found == 0xffff && player_ < 2 && quatter_ >= -1 && quatter_ < POSITION_LINES;
+}
+int Position::NumFreeSquares() const noexcept
+{
+    int count{0};
+    for (int8_t piece : squares_)
+        if (piece == NO_PIECE) ++count;
+
+    return count;
+}
+int Position::NumFreePieces() const noexcept
+{
+    int count{0};
+    for (int p{0}; p < POSITION_PIECES; ++p)
+        if (IsFree(p)) ++count;
+
+    return count;
+}
+
+void Position::Pick(int piece)
+{
+    picked_ = static_cast<int8_t>(piece);
+    free_ &= ~(1 << piece);
+    player_ = !player_;
+}
+void Position::Put(int square)
+{
+    quatter_ = static_cast<int8_t>(WinningLine(square, picked_));
+    squares_[square] = picked_;
+    picked_ = NO_PIECE;
+}
+
+//Returns the line that putting piece on square would complete with a shared attribute
+int Position::WinningLine(int square, int piece) const
+{
+    for (int l{0}; l < POSITION_LINES; ++l){
+
+        const int8_t* line{lines_[l]};
+        int same{0xf};
+        int inverse{0xf};
+        bool full{true};
+        bool crosses{false};
+
+        for (int i{0}; i < 4; ++i){
+
+            int occupant{line[i] == square ? piece : squares_[line[i]]};
+            if (line[i] == square)
+                crosses = true;
+
+            if (occupant == NO_PIECE){
+                full = false;
+                break;
+            }
+            same &= occupant;
+            inverse &= ~occupant;
+        }
+        if (crosses && full && (same || inverse))
+            return l;
+    }
+    return -1;
+}
+int Position::FindQuatter() const
+{
+    for (int l{0}; l < POSITION_LINES; ++l){
+
+        int same{0xf};
+        int inverse{0xf};
+        bool full{true};
+
+        for (int i{0}; i < 4; ++i){
+
+            int occupant{squares_[lines_[l][i]]};
+            if (occupant == NO_PIECE){
+                full = false;
+                break;
+            }
+            same &= occupant;
+            inverse &= ~occupant;
+        }
+        if (full && (same || inverse))
+            return l;
+    }
+    return -1;
+}
+//Whether the player receiving piece could win with it right away
+bool Position::GivesQuatter(int piece) const
+{
+    for (int s{0}; s < POSITION_SQUARES; ++s)
+        if (squares_[s] == NO_PIECE && WinningLine(s, piece) >= 0)
+            return true;
+
+    return false;
+}
+
+uint64_t Position::Key() const
+{
+    uint64_t key{0xcbf29ce484222325ull};
+    for (int8_t piece : squares_){
+        key ^= static_cast<uint8_t>(piece);
+        key *= 0x100000001b3ull;
+    }
+    key ^= static_cast<uint8_t>(picked_);
+    key *= 0x100000001b3ull;
+    key ^= player_;
+    key *= 0x100000001b3ull;
+
+    return key;
+}
+//One of the eight symmetries of the square combined with an attribute inversion mask
+Position Position::Transformed(int symmetry, int mask) const
+{
+    Position result{*this};
+
+    for (int s{0}; s < POSITION_SQUARES; ++s){
+
+        int x{s % 4};
+        int y{s / 4};
+        int tx{x};
+        int ty{y};
+
+        switch (symmetry){
+        default: case 0: break;
+        case 1: tx = 3 - y; ty = x;     break;
+        case 2: tx = 3 - x; ty = 3 - y; break;
+        case 3: tx = y;     ty = 3 - x; break;
+        case 4: tx = 3 - x;             break;
+        case 5:             ty = 3 - y; break;
+        case 6: tx = y;     ty = x;     break;
+        case 7: tx = 3 - y; ty = 3 - x; break;
+        }
+
+        int8_t piece{squares_[s]};
+        result.squares_[tx + 4 * ty] = piece == NO_PIECE ? piece : static_cast<int8_t>(piece ^ mask);
+    }
+    if (picked_ != NO_PIECE)
+        result.picked_ = static_cast<int8_t>(picked_ ^ mask);
+
+    result.free_ = 0;
+    for (int p{0}; p < POSITION_PIECES; ++p)
+        if (IsFree(p))
+            result.free_ |= 1 << (p ^ mask);
+
+    return result;
+}
+uint64_t Position::CanonicalKey() const
+{
+    uint64_t lowest{Key()};
+    for (int symmetry{0}; symmetry < 8; ++symmetry)
+        for (int mask{0}; mask < POSITION_PIECES; ++mask){
+
+            uint64_t key{Transformed(symmetry, mask).Key()};
+            if (key < lowest)
+                lowest = key;
+        }
+
+    return lowest;
+}
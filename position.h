@@ -0,0 +1,66 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <cstdint>
+
+//Engine independent game rules, shared by the game and the headless tools.
+//Squares are indexed x + 4 * y, pieces by their attributes as an int.
+
+#define POSITION_SQUARES 16
+#define POSITION_PIECES 16
+#define POSITION_LINES 19
+#define NO_PIECE -1
+
+struct Position
+{
+    int8_t squares_[POSITION_SQUARES];
+    int8_t picked_;     //Piece handed to the player that puts, NO_PIECE while picking
+    uint16_t free_;     //Pieces that are neither picked nor on the board
+    uint8_t player_;    //0 for player 1, 1 for player 2
+    int8_t quatter_;    //Winning line or -1
+
+    static Position Start();
+
+    bool InPickState() const noexcept { return picked_ == NO_PIECE && !IsOver(); }
+    bool InPutState() const noexcept { return picked_ != NO_PIECE && !IsOver(); }
+    bool IsOver() const noexcept { return quatter_ >= 0 || IsFull(); }
+    bool IsFull() const noexcept;
+    bool IsEmpty() const noexcept;
+    bool IsFree(int piece) const noexcept { return (free_ >> piece) & 1; }
+    bool IsValid() const noexcept;
+    int NumFreeSquares() const noexcept;
+    int NumFreePieces() const noexcept;
+
+    void Pick(int piece);
+    void Put(int square);
+
+    int WinningLine(int square, int piece) const;
+    int FindQuatter() const;
+    bool GivesQuatter(int piece) const;
+
+    uint64_t Key() const;
+    uint64_t CanonicalKey() const;
+    Position Transformed(int symmetry, int mask) const;
+
+    static const int8_t lines_[POSITION_LINES][4];
+};
+
+#endif // POSITION_H
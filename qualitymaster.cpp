@@ -0,0 +1,250 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "qualitymaster.h"
+#include "ecomaster.h"
+#include "shadowmaster.h"
+
+const QualityLevel QualityMaster::levels_[QUALITY_LEVELS]{
+//   shadow map  cascades  point shadows  bloom          fxaa   scale
+    { 1024,      4,        true,          BLOOM_HIGH,    true,  1.0f  },
+    { 1024,      2,        true,          BLOOM_HIGH,    true,  1.0f  },
+    {  512,      2,        false,         BLOOM_MEDIUM,  true,  0.85f },
+    {  512,      1,        false,         BLOOM_LOW,     true,  0.75f },
+    {  256,      1,        false,         BLOOM_OFF,     false, 0.6f  }
+};
+
+QualityMaster::QualityMaster(Context* context) : Master(context),
+    sun_{},
+    sunCascades_{},
+    shadowedLights_{},
+    overlay_{},
+    level_{0},
+    adaptive_{true},
+    bloomTier_{BLOOM_HIGH},
+    budget_{1.0f / TARGET_FPS},
+    frameTime_{budget_},
+    overTime_{0.0f},
+    underTime_{0.0f},
+    settleTime_{1.0f},
+    upgradeDelay_{3.0f},
+    sinceUpgrade_{M_INFINITY}
+{
+    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(QualityMaster, HandleUpdate));
+}
+
+//Call once the lights are baked, so baked lights only cast shadows while they need to
+void QualityMaster::Init()
+{
+    sun_.Reset();
+    shadowedLights_.Clear();
+
+    PODVector<Light*> lights{};
+    MC->world_.scene_->GetComponents<Light>(lights, true);
+    for (Light* light : lights){
+
+        if (!light->GetCastShadows())
+            continue;
+
+        if (light->GetLightType() == LIGHT_DIRECTIONAL && !sun_){
+
+            sun_ = light;
+            sunCascades_ = light->GetShadowCascade();
+        }
+        else if (light->GetLightType() != LIGHT_DIRECTIONAL)
+            shadowedLights_.Push(WeakPtr<Light>(light));
+    }
+
+    overlay_ = GetSubsystem<UI>()->GetRoot()->CreateChild<Text>();
+    overlay_->SetFont(CACHE->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 12);
+    overlay_->SetColor(Color(0.8f, 0.9f, 0.95f));
+    overlay_->SetPosition(8, 8);
+    overlay_->SetVisible(false);
+
+    ReadArguments();
+    ApplyLevel();
+}
+void QualityMaster::ReadArguments()
+{
+    //Full bloom like before, only the governor's lower levels or -bloom take it down
+    bloomTier_ = BLOOM_HIGH;
+
+    const Vector<String>& arguments{GetArguments()};
+    for (unsigned a{0}; a + 1 < arguments.Size(); ++a){
+
+        String argument{arguments[a].ToLower()};
+        if (argument == "-targetfps"){
+
+            float fps{ToFloat(arguments[a + 1])};
+            if (fps > 0.0f)
+                budget_ = 1.0f / fps;
+
+        } else if (argument == "-quality"){
+
+            level_ = Clamp(ToInt(arguments[a + 1]), 0, QUALITY_LEVELS - 1);
+            adaptive_ = false;
+
+        } else if (argument == "-bloom"){
+
+            String tier{arguments[a + 1].ToLower()};
+            if (tier == "off")
+                bloomTier_ = BLOOM_OFF;
+            else if (tier == "low")
+                bloomTier_ = BLOOM_LOW;
+            else if (tier == "medium")
+                bloomTier_ = BLOOM_MEDIUM;
+            else if (tier == "high")
+                bloomTier_ = BLOOM_HIGH;
+        }
+    }
+    frameTime_ = budget_;
+}
+
+void QualityMaster::SetLevel(int level)
+{
+    level = Clamp(level, 0, QUALITY_LEVELS - 1);
+    if (level == level_)
+        return;
+
+    level_ = level;
+    ApplyLevel();
+}
+void QualityMaster::ApplyLevel()
+{
+    const QualityLevel& quality{levels_[level_]};
+
+    GetSubsystem<Renderer>()->SetShadowMapSize(quality.shadowMapSize_);
+    if (sun_)
+        sun_->SetShadowCascade(Cascades(quality.cascades_));
+
+    ApplyShadows();
+
+    QuatterCam* camera{MC->world_.camera_};
+    camera->SetPostProcess(Min(quality.bloom_, bloomTier_), quality.fxaa_);
+    camera->SetRenderScale(quality.renderScale_);
+
+    //Frame times around a switch say little about the new level
+    settleTime_ = 1.0f;
+    overTime_ = underTime_ = 0.0f;
+
+    Log::Write(LOG_INFO, "Quality level " + String(level_)
+               + " at " + String(frameTime_ * 1000.0f) + " ms per frame");
+    UpdateOverlay();
+}
+//The only place point light shadows are switched
+void QualityMaster::ApplyShadows()
+{
+    ShadowMaster* shadowMaster{GetSubsystem<ShadowMaster>()};
+    bool pointShadows{levels_[level_].pointShadows_};
+
+    for (Light* light : shadowedLights_)
+        if (light)
+            light->SetCastShadows(pointShadows && shadowMaster->NeedsShadows(light));
+}
+//Fewer cascades cover the same distance, split closer to the camera
+CascadeParameters QualityMaster::Cascades(int count) const
+{
+    if (count >= 4)
+        return sunCascades_;
+
+    float reach{sunCascades_.splits_.w_};
+    float splits[4]{};
+    for (int c{0}; c < count; ++c){
+
+        float part{static_cast<float>(c + 1) / count};
+        splits[c] = reach * part * part;
+    }
+
+    return CascadeParameters(splits[0], splits[1], splits[2], splits[3],
+                             sunCascades_.fadeStart_, sunCascades_.biasAutoAdjust_);
+}
+
+void QualityMaster::ToggleOverlay()
+{
+    if (!overlay_)
+        return;
+
+    overlay_->SetVisible(!overlay_->IsVisible());
+    UpdateOverlay();
+}
+void QualityMaster::UpdateOverlay()
+{
+    if (!overlay_ || !overlay_->IsVisible())
+        return;
+
+    overlay_->SetText("Quality " + String(level_) + (adaptive_ ? "" : " (fixed)")
+                    + "\n" + String(RoundToInt(frameTime_ * 10000.0f) * 0.1f)
+                    + " / " + String(RoundToInt(budget_ * 10000.0f) * 0.1f) + " ms");
+}
+
+void QualityMaster::HandleUpdate(StringHash eventType, VariantMap& eventData)
+{ (void)eventType;
+
+    //Eco frames are slow on purpose
+    if (!GetSubsystem<EcoMaster>()->IsAwake()){
+
+        settleTime_ = 1.0f;
+        return;
+    }
+
+    float timeStep{eventData[Update::P_TIMESTEP].GetFloat()};
+    frameTime_ = Lerp(frameTime_, timeStep, 0.1f);
+    sinceUpgrade_ += timeStep;
+    UpdateOverlay();
+
+    if (!adaptive_)
+        return;
+
+    if (settleTime_ > 0.0f){
+
+        settleTime_ -= timeStep;
+        return;
+    }
+
+    //With vsync frames never come in faster than the refresh rate
+    float upgradeBelow{budget_ * (GRAPHICS->GetVSync() ? 1.02f : 0.8f)};
+
+    if (frameTime_ > budget_ * 1.2f){
+
+        overTime_ += timeStep;
+        underTime_ = 0.0f;
+
+    } else if (frameTime_ < upgradeBelow){
+
+        underTime_ += timeStep;
+        overTime_ = 0.0f;
+
+    } else {
+
+        overTime_ = underTime_ = 0.0f;
+    }
+
+    if (overTime_ > 0.5f && level_ < QUALITY_LEVELS - 1){
+
+        //Back off further before retrying a level that could not be held
+        if (sinceUpgrade_ < 10.0f)
+            upgradeDelay_ = Min(upgradeDelay_ * 2.0f, 60.0f);
+
+        SetLevel(level_ + 1);
+
+    } else if (underTime_ > upgradeDelay_ && level_ > 0){
+
+        sinceUpgrade_ = 0.0f;
+        SetLevel(level_ - 1);
+    }
+}
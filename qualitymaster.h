@@ -0,0 +1,82 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef QUALITYMASTER_H
+#define QUALITYMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include "master.h"
+#include "quattercam.h"
+
+#define QUALITY_LEVELS 5
+#define TARGET_FPS 60.0f
+
+//Settings for one step on the quality ladder, from best to cheapest
+struct QualityLevel
+{
+    int shadowMapSize_;
+    int cascades_;
+    bool pointShadows_;
+    BloomTier bloom_;   //Cheapest of this and the preferred tier is used
+    bool fxaa_;
+    float renderScale_;
+};
+
+//Steps the render settings down when frames take longer than the budget and
+//back up when there is room again, waiting longer each time an upgrade fails.
+class QualityMaster : public Master
+{
+    URHO3D_OBJECT(QualityMaster, Master);
+public:
+    QualityMaster(Context* context);
+
+    void Init();
+    void SetLevel(int level);
+    void ApplyShadows();
+    int GetLevel() const { return level_; }
+    void SetAdaptive(bool adaptive) { adaptive_ = adaptive; }
+    bool IsAdaptive() const { return adaptive_; }
+    float GetBudget() const { return budget_; }
+    void ToggleOverlay();
+private:
+    static const QualityLevel levels_[QUALITY_LEVELS];
+
+    WeakPtr<Light> sun_;
+    CascadeParameters sunCascades_;
+    Vector< WeakPtr<Light> > shadowedLights_;
+    SharedPtr<Text> overlay_;
+
+    int level_;
+    bool adaptive_;
+    BloomTier bloomTier_;
+    float budget_;
+    float frameTime_;
+    float overTime_;
+    float underTime_;
+    float settleTime_;
+    float upgradeDelay_;
+    float sinceUpgrade_;
+
+    void ReadArguments();
+    void ApplyLevel();
+    CascadeParameters Cascades(int count) const;
+    void UpdateOverlay();
+    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+};
+
+#endif // QUALITYMASTER_H
@@ -17,6 +17,7 @@
 */
 
 #include "quattercam.h"
+#include "glowmodel.h"
 #include <initializer_list>
 
 void QuatterCam::RegisterObject(Context *context)
@@ -27,7 +28,12 @@ void QuatterCam::RegisterObject(Context *context)
 QuatterCam::QuatterCam(Context* context) : LogicComponent(context),
     distance_{12.0f},
     aimDistance_{distance_},
-    targetPosition_{Vector3::UP * 0.42f}
+    targetPosition_{Vector3::UP * 0.42f},
+    renderPathFile_{},
+    renderScale_{1.0f},
+    bloomTier_{BLOOM_HIGH},
+    fxaa_{true},
+    glowVisible_{true}
 {
 }
 void QuatterCam::OnNodeSet(Node *node)
@@ -66,22 +72,154 @@ void QuatterCam::SetupViewport()
 {
     SharedPtr<Viewport> viewport(new Viewport(context_, MC->world_.scene_, camera_));
     viewport_ = viewport;
+    SetRenderPath(CACHE->GetResource<XMLFile>("RenderPaths/Forward.xml"));
 
-    //Add anti-asliasing and bloom
+    Renderer* renderer{GetSubsystem<Renderer>()};
+    renderer->SetViewport(0, viewport_);
+}
+void QuatterCam::SetRenderPath(XMLFile* renderPath)
+{
+    renderPathFile_ = renderPath;
+    RebuildRenderPath();
+}
+void QuatterCam::RebuildRenderPath()
+{
+    viewport_->SetRenderPath(renderPathFile_);
     effectRenderPath_ = viewport_->GetRenderPath();
+
+    if (renderScale_ < 1.0f)
+        ScaleScenePasses();
+
+    //Add anti-asliasing and bloom
     effectRenderPath_->Append(CACHE->GetResource<XMLFile>("PostProcess/FXAA3.xml"));
-    effectRenderPath_->SetEnabled("FXAA3", true);
-    effectRenderPath_->Append(CACHE->GetResource<XMLFile>("PostProcess/BloomHDR.xml"));
+    effectRenderPath_->SetEnabled("FXAA3", fxaa_);
+    for (String bloom : {"BloomLow", "BloomMedium", "BloomHDR"})
+        effectRenderPath_->Append(CACHE->GetResource<XMLFile>("PostProcess/" + bloom + ".xml"));
+    effectRenderPath_->SetShaderParameter("BloomThreshold", 0.4f);
+    effectRenderPath_->SetShaderParameter("BloomMix", Vector2(1.0f, 0.8f));
     effectRenderPath_->SetShaderParameter("BloomHDRThreshold", 0.4f);
     effectRenderPath_->SetShaderParameter("BloomHDRMix", Vector2(1.0f, 1.25f));
-    effectRenderPath_->SetEnabled("BloomHDR", true);
+    ApplyBloom();
+}
+//Renders the scene into a smaller target and stretches it over the viewport before post-processing
+void QuatterCam::ScaleScenePasses()
+{
+    RenderPath* path{effectRenderPath_};
 
-    Renderer* renderer{GetSubsystem<Renderer>()};
-    renderer->SetViewport(0, viewport_);
+    for (RenderTargetInfo& target : path->renderTargets_)
+        if (target.sizeMode_ == SIZE_VIEWPORTDIVISOR)
+            target.size_ /= renderScale_;
+        else if (target.sizeMode_ == SIZE_VIEWPORTMULTIPLIER)
+            target.size_ *= renderScale_;
+
+    for (RenderPathCommand& command : path->commands_){
+
+        for (Pair<String, CubeMapFace>& output : command.outputs_)
+            if (output.first_.Compare("viewport", false) == 0)
+                output.first_ = "scaled";
+
+        for (String& texture : command.textureNames_)
+            if (texture.Compare("viewport", false) == 0)
+                texture = "scaled";
+
+        if (command.depthStencilName_.Empty())
+            command.depthStencilName_ = "scaleddepth";
+    }
+
+    RenderTargetInfo scaled{};
+    scaled.name_ = "scaled";
+    scaled.tag_ = "RenderScale";
+    scaled.format_ = Graphics::GetRGBAFormat();
+    scaled.sizeMode_ = SIZE_VIEWPORTMULTIPLIER;
+    scaled.size_ = Vector2::ONE * renderScale_;
+    scaled.filtered_ = true;
+    path->AddRenderTarget(scaled);
+
+    RenderTargetInfo depth{scaled};
+    depth.name_ = "scaleddepth";
+    depth.format_ = Graphics::GetDepthStencilFormat();
+    depth.filtered_ = false;
+    path->AddRenderTarget(depth);
+
+    RenderPathCommand upscale{};
+    upscale.tag_ = "RenderScale";
+    upscale.type_ = CMD_QUAD;
+    upscale.vertexShaderName_ = "CopyFramebuffer";
+    upscale.pixelShaderName_ = "CopyFramebuffer";
+    upscale.SetTextureName(TU_DIFFUSE, "scaled");
+    upscale.SetOutput(0, "viewport");
+    path->AddCommand(upscale);
+}
+void QuatterCam::SetRenderScale(float scale)
+{
+    scale = Clamp(scale, 0.25f, 1.0f);
+    if (scale == renderScale_)
+        return;
+
+    renderScale_ = scale;
+    RebuildRenderPath();
+}
+void QuatterCam::SetPostProcess(BloomTier bloom, bool fxaa)
+{
+    bloomTier_ = bloom;
+    fxaa_ = fxaa;
+
+    effectRenderPath_->SetEnabled("FXAA3", fxaa_);
+    ApplyBloom();
+}
+//At most one bloom chain runs, and none while nothing glows
+void QuatterCam::ApplyBloom()
+{
+    BloomTier tier{glowVisible_ ? bloomTier_ : BLOOM_OFF};
+
+    effectRenderPath_->SetEnabled("BloomLow", tier == BLOOM_LOW);
+    effectRenderPath_->SetEnabled("BloomMedium", tier == BLOOM_MEDIUM);
+    effectRenderPath_->SetEnabled("BloomHDR", tier == BLOOM_HIGH);
+}
+//Forward lighting costs a pass per light per lit object, light volumes a pass per light
+void QuatterCam::SelectRenderPath()
+{
+    PODVector<Light*> lights{};
+    GetScene()->GetComponents<Light>(lights, true);
+
+    String renderPath{"Forward"};
+    if (lights.Size() >= LIGHT_VOLUME_THRESHOLD){
+
+        if (GRAPHICS->GetDeferredSupport())
+            renderPath = "Deferred";
+        else if (GRAPHICS->GetLightPrepassSupport())
+            renderPath = "Prepass";
+    }
+
+    //Allow overriding the choice, as far as the GPU supports it
+    const Vector<String>& arguments{GetArguments()};
+    for (unsigned a{0}; a + 1 < arguments.Size(); ++a){
+
+        if (arguments[a].ToLower() != "-renderpath")
+            continue;
+
+        String forced{arguments[a + 1].ToLower()};
+        if (forced == "forward")
+            renderPath = "Forward";
+        else if (forced == "prepass" && GRAPHICS->GetLightPrepassSupport())
+            renderPath = "Prepass";
+        else if (forced == "deferred" && GRAPHICS->GetDeferredSupport())
+            renderPath = "Deferred";
+    }
+
+    SetRenderPath(CACHE->GetResource<XMLFile>("RenderPaths/" + renderPath + ".xml"));
+    Log::Write(LOG_INFO, renderPath + " render path for " + String(lights.Size()) + " lights");
 }
 
 void QuatterCam::Update(float timeStep)
 {
+    //Skip bloom while every glow is faded out or out of view
+    bool glowVisible{GlowModel::IsGlowVisible()};
+    if (glowVisible != glowVisible_){
+
+        glowVisible_ = glowVisible;
+        ApplyBloom();
+    }
 
     //Update distance
     if (aimDistance_ != distance_)
@@ -117,6 +255,14 @@ void QuatterCam::Rotate(Vector2 rotation)
                                 Quaternion(PITCH_MIN - GetPitch(), node_->GetRight()),
                                 TS_WORLD);
 }
+void QuatterCam::SetView(float yaw, float pitch, float distance)
+{
+    distance_ = aimDistance_ = Clamp(distance, ZOOM_MIN, ZOOM_MAX);
+
+    node_->SetRotation(Quaternion(Clamp(pitch, PITCH_MIN, PITCH_MAX), yaw, 0.0f));
+    node_->SetPosition(targetPosition_ - node_->GetDirection() * distance_);
+    camera_->SetFov(Clamp(60.0f + distance_, 23.0f, 110.0f));
+}
 void QuatterCam::Zoom(float delta)
 {
     aimDistance_ = Clamp(aimDistance_ - delta, ZOOM_MIN, ZOOM_MAX);
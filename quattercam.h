@@ -41,11 +41,18 @@ using namespace Urho3D;
 #define ZOOM_MAX 23.0f
 #define ZOOM_EDGE 7.0f
 
+#define LIGHT_VOLUME_THRESHOLD 8
+
+//Each step down blurs fewer mip levels in lighter render targets
+enum BloomTier{BLOOM_OFF, BLOOM_LOW, BLOOM_MEDIUM, BLOOM_HIGH};
+
 class QuatterCam : public LogicComponent
 {
     URHO3D_OBJECT(QuatterCam, LogicComponent);
     friend class MasterControl;
     friend class InputMaster;
+    friend class BenchMaster;
+    friend class ReplayMaster;
 public:
     QuatterCam(Context* context);
     static void RegisterObject(Context* context);
@@ -64,9 +71,15 @@ public:
 
     void SetDistance(float distance) { aimDistance_ = Clamp(distance, ZOOM_MIN, ZOOM_MAX); }
     float GetDistance() const { return distance_; }
+    bool IsSettled() const { return Abs(aimDistance_ - distance_) < 0.001f; }
     void Zoom(float delta);
     void ZoomToBoard() { SetDistance(6.0f); }
     void ZoomToTable() { SetDistance(13.0f); }
+    void SetView(float yaw, float pitch, float distance);
+    void SelectRenderPath();
+    void SetRenderScale(float scale);
+    float GetRenderScale() const { return renderScale_; }
+    void SetPostProcess(BloomTier bloom, bool fxaa);
 
 private:
     Pair<SharedPtr<Node>,
@@ -75,9 +88,17 @@ private:
     float distance_;
     float aimDistance_;
     Vector3 targetPosition_;
-
+    SharedPtr<XMLFile> renderPathFile_;
+    float renderScale_;
+    BloomTier bloomTier_;
+    bool fxaa_;
+    bool glowVisible_;
 
     void SetupViewport();
+    void SetRenderPath(XMLFile* renderPath);
+    void RebuildRenderPath();
+    void ScaleScenePasses();
+    void ApplyBloom();
     void Rotate(Vector2 rotation);
     void CreatePockets();
 };
@@ -0,0 +1,42 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "randomstream.h"
+
+#define PCG_MULTIPLIER 6364136223846793005ull
+#define PCG_INCREMENT 1442695040888963407ull
+
+void RandomStream::Seed(uint32_t seed)
+{
+    seed_ = seed;
+    state_ = 0u;
+    Next();
+    state_ += seed;
+    Next();
+}
+
+uint32_t RandomStream::Next()
+{
+    uint64_t old{state_};
+    state_ = old * PCG_MULTIPLIER + PCG_INCREMENT;
+
+    uint32_t shifted{static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u)};
+    uint32_t rotation{static_cast<uint32_t>(old >> 59u)};
+
+    return (shifted >> rotation) | (shifted << ((-rotation) & 31u));
+}
@@ -0,0 +1,49 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <cstdint>
+
+//Seeded PCG32 generator. Every game and headless worker owns one,
+//so a stored seed reproduces the same sequence on any platform.
+class RandomStream
+{
+public:
+    RandomStream(uint32_t seed = 0u) { Seed(seed); }
+
+    void Seed(uint32_t seed);
+    uint32_t GetSeed() const noexcept { return seed_; }
+    //Where in the sequence of its seed the stream is
+    uint64_t GetState() const noexcept { return state_; }
+    void SetState(uint64_t state) noexcept { state_ = state; }
+
+    uint32_t Next();
+    int Int(int range) { return static_cast<int>((static_cast<uint64_t>(Next()) * static_cast<uint32_t>(range)) >> 32); }
+    float Float() { return (Next() >> 8) * (1.0f / 16777216.0f); }
+    float Float(float range) { return Float() * range; }
+    float Float(float min, float max) { return min + Float() * (max - min); }
+    //Seed for an independent child stream
+    uint32_t Fork() { return Next() ^ 0x9e3779b9u; }
+private:
+    uint32_t seed_;
+    uint64_t state_;
+};
+
+#endif // RANDOMSTREAM_H
@@ -0,0 +1,47 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <cstdint>
+
+#include "position.h"
+
+//A full game is 16 picks and 16 puts
+#define RECORDING_MOVES 32
+
+//A pick when square_ is NO_PIECE, a put otherwise
+struct RecordedMove
+{
+    float time_;    //Seconds since the game started
+    int8_t piece_;
+    int8_t square_;
+};
+
+//Every move of one game from the empty board, to replay it later
+struct Recording
+{
+    unsigned seed_;
+    uint64_t state_;    //Game stream right before the first move
+    unsigned char startGameState_;
+    unsigned numMoves_;
+    RecordedMove moves_[RECORDING_MOVES];
+};
+
+#endif // RECORDING_H
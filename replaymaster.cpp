@@ -0,0 +1,183 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "replaymaster.h"
+#include "capturemaster.h"
+#include "qualitymaster.h"
+#include "savemaster.h"
+#include "quattercam.h"
+#include "board.h"
+#include "piece.h"
+
+#include <Urho3D/Graphics/GraphicsEvents.h>
+#include <Urho3D/Graphics/RenderSurface.h>
+#include <Urho3D/Resource/Image.h>
+
+ReplayMaster::ReplayMaster(Context* context) : Master(context),
+    loaded_{false},
+    fileName_{},
+    outputFolder_{},
+    fps_{REPLAY_FPS},
+    size_{REPLAY_WIDTH, REPLAY_HEIGHT},
+    recording_{},
+    moveTimes_{},
+    nextMove_{0},
+    time_{0.0f},
+    endTime_{0.0f},
+    numFrames_{0},
+    target_{}
+{
+    const Vector<String>& arguments{GetArguments()};
+    for (unsigned a{0}; a + 1 < arguments.Size(); ++a){
+
+        String argument{arguments[a].ToLower()};
+
+        if (argument == REPLAY_ARGUMENT)
+            fileName_ = arguments[a + 1];
+        else if (argument == "-replayout")
+            outputFolder_ = AddTrailingSlash(arguments[a + 1]);
+        else if (argument == "-replayfps")
+            fps_ = Max(1.0f, ToFloat(arguments[a + 1]));
+        else if (argument == "-replaysize"){
+
+            Vector<String> size{arguments[a + 1].ToLower().Split('x')};
+            if (size.Size() == 2)
+                size_ = IntVector2(Max(16, ToInt(size[0])), Max(16, ToInt(size[1])));
+        }
+    }
+
+    //Frames go next to where the clip was asked for, in a folder named after the recording
+    if (outputFolder_.Empty())
+        outputFolder_ = FILES->GetCurrentDir() + GetFileName(fileName_) + "/";
+
+    //Read before the scene is created, its pieces are laid out from the recorded seed
+    loaded_ = !fileName_.Empty() && GetSubsystem<SaveMaster>()->LoadRecording(fileName_, recording_);
+}
+
+bool ReplayMaster::IsRequested(const Vector<String>& arguments)
+{
+    for (const String& argument : arguments)
+        if (argument.ToLower() == REPLAY_ARGUMENT)
+            return true;
+
+    return false;
+}
+
+void ReplayMaster::Start()
+{
+    if (!loaded_){
+
+        Log::Write(LOG_ERROR, "Could not load recording " + fileName_);
+        ENGINE->Exit();
+        return;
+    }
+
+    //Same draws, same offsets and twists of every put. Laying out the
+    //pieces drew from the stream before the first move was recorded.
+    MC->random_.Seed(recording_.seed_);
+    MC->random_.SetState(recording_.state_);
+    MC->gameState_ = recording_.startGameState_ == static_cast<unsigned char>(GameState::PLAYER2PICKS)
+                   ? GameState::PLAYER2PICKS : GameState::PLAYER1PICKS;
+    MC->startGameState_ = MC->gameState_;
+    MC->history_.Clear(MC->GetPosition());
+
+    GetSubsystem<QualityMaster>()->SetAdaptive(false);
+    CAMERA->SetView(0.0f, 45.0f, 13.0f);
+
+    //The camera renders into a texture instead of the window
+    target_ = new Texture2D(context_);
+    target_->SetSize(size_.x_, size_.y_, Graphics::GetRGBFormat(), TEXTURE_RENDERTARGET);
+    RenderSurface* surface{target_->GetRenderSurface()};
+    surface->SetViewport(0, CAMERA->viewport_);
+    surface->SetUpdateMode(SURFACE_UPDATEALWAYS);
+    GetSubsystem<Renderer>()->SetViewport(0, nullptr);
+
+    FILES->CreateDir(outputFolder_);
+    Schedule();
+
+    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(ReplayMaster, HandleUpdate));
+    SubscribeToEvent(E_ENDRENDERING, URHO3D_HANDLER(ReplayMaster, HandleEndRendering));
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(ReplayMaster, HandleEndFrame));
+    ENGINE->SetNextTimeStep(1.0f / fps_);
+
+    Log::Write(LOG_INFO, "Replaying " + String(recording_.numMoves_) + " moves of " + fileName_ + " to " + outputFolder_);
+}
+//Keeps the rhythm of the game without its long pauses or moves that cut off each other's animations
+void ReplayMaster::Schedule()
+{
+    float time{REPLAY_LEAD_TIME};
+    for (unsigned m{0}; m < recording_.numMoves_; ++m){
+
+        if (m > 0)
+            time += Clamp(recording_.moves_[m].time_ - recording_.moves_[m - 1].time_, REPLAY_MIN_GAP, REPLAY_MAX_GAP);
+
+        moveTimes_[m] = time;
+    }
+    endTime_ = time + REPLAY_TAIL_TIME;
+}
+void ReplayMaster::PlayMove(const RecordedMove& move)
+{
+    if (move.square_ == NO_PIECE){
+
+        if (MC->InPickState())
+            MC->world_.pieces_[move.piece_]->Pick();
+
+    } else if (MC->InPutState() && MC->GetPickedPiece()){
+
+        BOARD->PutPiece(MC->GetPickedPiece(), BOARD->GetSquare(move.square_));
+    }
+}
+void ReplayMaster::Finish()
+{
+    UnsubscribeFromAllEvents();
+
+    Log::Write(LOG_INFO, "Replay written as " + String(numFrames_) + " frames");
+    GetSubsystem<CaptureMaster>()->Finish();
+    ENGINE->Exit();
+}
+
+void ReplayMaster::HandleUpdate(StringHash eventType, VariantMap& eventData)
+{ (void)eventType;
+
+    float timeStep{eventData[Update::P_TIMESTEP].GetFloat()};
+    time_ += timeStep;
+
+    while (nextMove_ < recording_.numMoves_ && time_ >= moveTimes_[nextMove_])
+        PlayMove(recording_.moves_[nextMove_++]);
+
+    CAMERA->Rotate(Vector2(REPLAY_ORBIT_SPEED * timeStep, 0.0f));
+
+    if (time_ >= endTime_)
+        Finish();
+}
+void ReplayMaster::HandleEndRendering(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    SharedPtr<Image> image{target_->GetImage()};
+    if (!image)
+        return;
+
+    GetSubsystem<CaptureMaster>()->SavePNG(*image, outputFolder_ + ToString("frame_%05u.png", numFrames_));
+    ++numFrames_;
+}
+//Every frame moves the game on by the same amount, however long it took to render
+void ReplayMaster::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    ENGINE->SetNextTimeStep(1.0f / fps_);
+}
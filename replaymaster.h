@@ -0,0 +1,79 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef REPLAYMASTER_H
+#define REPLAYMASTER_H
+
+#include <Urho3D/Urho3D.h>
+
+#include "master.h"
+#include "recording.h"
+
+#define REPLAY_ARGUMENT "--replay"
+#define REPLAY_FPS 30.0f
+#define REPLAY_WIDTH 1280
+#define REPLAY_HEIGHT 720
+#define REPLAY_LEAD_TIME 1.0f
+#define REPLAY_MIN_GAP 0.5f
+#define REPLAY_MAX_GAP 2.3f
+#define REPLAY_TAIL_TIME 4.0f
+#define REPLAY_ORBIT_SPEED 5.0f
+
+namespace Urho3D {
+class Texture2D;
+}
+
+//Plays a recorded game on the scene at a fixed timestep and writes every frame,
+//rendered into an offscreen target, as a numbered PNG. Simulated time only
+//moves on once a frame is done, so clips come out the same on a fast GPU
+//or on a software rasterizer without a display.
+//
+//Usage: quatter --replay Game.qrec [-replayout Folder] [-replayfps 30] [-replaysize 1280x720]
+class ReplayMaster : public Master
+{
+    URHO3D_OBJECT(ReplayMaster, Master);
+public:
+    ReplayMaster(Context* context);
+
+    static bool IsRequested(const Vector<String>& arguments);
+    bool IsLoaded() const { return loaded_; }
+    unsigned GetSeed() const { return recording_.seed_; }
+    void Start();
+private:
+    bool loaded_;
+    String fileName_;
+    String outputFolder_;
+    float fps_;
+    IntVector2 size_;
+    Recording recording_;
+    float moveTimes_[RECORDING_MOVES];
+    unsigned nextMove_;
+    float time_;
+    float endTime_;
+    unsigned numFrames_;
+    SharedPtr<Texture2D> target_;
+
+    void Schedule();
+    void PlayMove(const RecordedMove& move);
+    void Finish();
+    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleEndRendering(StringHash eventType, VariantMap& eventData);
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+};
+
+#endif // REPLAYMASTER_H
@@ -0,0 +1,236 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "savemaster.h"
+
+#include <cstdio>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+SaveMaster::SaveMaster(Context* context) : Master(context),
+    fileName_{FILES->GetAppPreferencesDir("luckey", "quatter") + "Resume.qsnap"},
+    bufferMutex_{},
+    fileMutex_{},
+    pending_{},
+    pendingSequence_{0},
+    writtenSequence_{0}
+{
+}
+
+//Serializes on the calling thread and leaves the disk access to a worker
+void SaveMaster::Save(const Snapshot& snapshot)
+{
+    {
+        MutexLock lock{bufferMutex_};
+
+        pending_.Clear();
+        pending_.WriteFileID("QSAV");
+        pending_.WriteUByte(SNAPSHOT_VERSION);
+
+        const Position& position{snapshot.position_};
+        for (int8_t piece : position.squares_)
+            pending_.WriteByte(piece);
+        pending_.WriteByte(position.picked_);
+        pending_.WriteUShort(position.free_);
+        pending_.WriteUByte(position.player_);
+        pending_.WriteByte(position.quatter_);
+
+        pending_.WriteUByte(snapshot.gameState_);
+        pending_.WriteUByte(snapshot.previousGameState_);
+        pending_.WriteUByte(snapshot.startGameState_);
+        pending_.WriteUByte(snapshot.selectionMode_);
+        pending_.WriteUByte(snapshot.musicState_);
+        pending_.WriteUByte(snapshot.previousMusicState_);
+        pending_.WriteFloat(snapshot.musicGain_);
+        pending_.WriteFloat(snapshot.cameraYaw_);
+        pending_.WriteFloat(snapshot.cameraPitch_);
+        pending_.WriteFloat(snapshot.cameraDistance_);
+        pending_.WriteUInt(snapshot.seed_);
+
+        ++pendingSequence_;
+    }
+
+    WorkQueue* queue{GetSubsystem<WorkQueue>()};
+    SharedPtr<WorkItem> item{queue->GetFreeItem()};
+    item->workFunction_ = WriteSnapshot;
+    item->aux_ = this;
+    item->sendEvent_ = false;
+    queue->AddWorkItem(item);
+}
+void SaveMaster::WriteSnapshot(const WorkItem* item, unsigned threadIndex)
+{ (void)threadIndex;
+
+    static_cast<SaveMaster*>(item->aux_)->Write();
+}
+void SaveMaster::Write()
+{
+    MutexLock fileLock{fileMutex_};
+
+    PODVector<unsigned char> data{};
+    unsigned sequence{};
+    {
+        MutexLock lock{bufferMutex_};
+
+        //A newer snapshot was already written by another worker
+        if (writtenSequence_ >= pendingSequence_)
+            return;
+
+        data = pending_.GetBuffer();
+        sequence = pendingSequence_;
+    }
+
+    //Write next to the old snapshot, get it onto the disk and swap,
+    //so a power cut leaves either the old or the new snapshot
+    String tempName{fileName_ + ".tmp"};
+    {
+        File file{context_, tempName, FILE_WRITE};
+        if (!file.IsOpen() || file.Write(&data[0], data.Size()) != data.Size())
+            return;
+
+        file.Flush();
+        SyncToDisk(file);
+    }
+    //Renaming over the old file replaces it atomically where the platform allows it
+    if (!FILES->Rename(tempName, fileName_)){
+
+        FILES->Delete(fileName_);
+        if (!FILES->Rename(tempName, fileName_))
+            return;
+    }
+    writtenSequence_ = sequence;
+}
+void SaveMaster::SyncToDisk(File& file)
+{
+    FILE* handle{static_cast<FILE*>(file.GetHandle())};
+    if (!handle)
+        return;
+
+#ifdef _WIN32
+    _commit(_fileno(handle));
+#else
+    fsync(fileno(handle));
+#endif
+}
+void SaveMaster::Flush()
+{
+    GetSubsystem<WorkQueue>()->Complete(M_MAX_UNSIGNED);
+}
+
+bool SaveMaster::Load(Snapshot& snapshot)
+{
+    if (!FILES->FileExists(fileName_))
+        return false;
+
+    File file{context_, fileName_, FILE_READ};
+    if (!file.IsOpen()
+     || file.ReadFileID() != "QSAV"
+     || file.ReadUByte() != SNAPSHOT_VERSION)
+        return false;
+
+    Position& position{snapshot.position_};
+    for (int8_t& piece : position.squares_)
+        piece = file.ReadByte();
+    position.picked_ = file.ReadByte();
+    position.free_ = file.ReadUShort();
+    position.player_ = file.ReadUByte();
+    position.quatter_ = file.ReadByte();
+
+    snapshot.gameState_ = file.ReadUByte();
+    snapshot.previousGameState_ = file.ReadUByte();
+    snapshot.startGameState_ = file.ReadUByte();
+    snapshot.selectionMode_ = file.ReadUByte();
+    snapshot.musicState_ = file.ReadUByte();
+    snapshot.previousMusicState_ = file.ReadUByte();
+    snapshot.musicGain_ = file.ReadFloat();
+    snapshot.cameraYaw_ = file.ReadFloat();
+    snapshot.cameraPitch_ = file.ReadFloat();
+    snapshot.cameraDistance_ = file.ReadFloat();
+    snapshot.seed_ = file.ReadUInt();
+
+    return position.IsValid()
+        && snapshot.gameState_ <= static_cast<unsigned char>(GameState::QUATTER)
+        && snapshot.previousGameState_ <= static_cast<unsigned char>(GameState::QUATTER)
+        && snapshot.startGameState_ <= static_cast<unsigned char>(GameState::QUATTER)
+        && snapshot.selectionMode_ <= SM_YAD
+        && snapshot.musicState_ <= MUSIC_OFF
+        && snapshot.previousMusicState_ <= MUSIC_OFF;
+}
+
+//Finished games go to the Recordings folder, one small file each
+void SaveMaster::SaveRecording(const Recording& recording)
+{
+    String folder{FILES->GetAppPreferencesDir("luckey", "quatter") + "Recordings/"};
+    FILES->CreateDir(folder);
+    String fileName{folder + "Game_" + Time::GetTimeStamp().Replaced(':', '_').Replaced('.', '_').Replaced(' ', '_') + ".qrec"};
+
+    File file{context_, fileName, FILE_WRITE};
+    if (!file.IsOpen())
+        return;
+
+    file.WriteFileID("QREC");
+    file.WriteUByte(RECORDING_VERSION);
+    file.WriteUInt(recording.seed_);
+    file.WriteUInt(static_cast<unsigned>(recording.state_));
+    file.WriteUInt(static_cast<unsigned>(recording.state_ >> 32));
+    file.WriteUByte(recording.startGameState_);
+    file.WriteUByte(static_cast<unsigned char>(recording.numMoves_));
+
+    for (unsigned m{0}; m < recording.numMoves_; ++m){
+
+        const RecordedMove& move{recording.moves_[m]};
+        file.WriteFloat(move.time_);
+        file.WriteByte(move.piece_);
+        file.WriteByte(move.square_);
+    }
+}
+bool SaveMaster::LoadRecording(const String& fileName, Recording& recording)
+{
+    if (!FILES->FileExists(fileName))
+        return false;
+
+    File file{context_, fileName, FILE_READ};
+    if (!file.IsOpen()
+     || file.ReadFileID() != "QREC"
+     || file.ReadUByte() != RECORDING_VERSION)
+        return false;
+
+    recording.seed_ = file.ReadUInt();
+    recording.state_ = file.ReadUInt();
+    recording.state_ |= static_cast<uint64_t>(file.ReadUInt()) << 32;
+    recording.startGameState_ = file.ReadUByte();
+    recording.numMoves_ = file.ReadUByte();
+    if (recording.numMoves_ > RECORDING_MOVES)
+        return false;
+
+    for (unsigned m{0}; m < recording.numMoves_; ++m){
+
+        RecordedMove& move{recording.moves_[m]};
+        move.time_ = file.ReadFloat();
+        move.piece_ = file.ReadByte();
+        move.square_ = file.ReadByte();
+
+        if (move.piece_ < 0 || move.piece_ >= POSITION_PIECES
+         || move.square_ < NO_PIECE || move.square_ >= POSITION_SQUARES)
+            return false;
+    }
+
+    return true;
+}
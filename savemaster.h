@@ -0,0 +1,78 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SAVEMASTER_H
+#define SAVEMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include <Urho3D/Core/Mutex.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/VectorBuffer.h>
+
+#include "master.h"
+#include "position.h"
+#include "recording.h"
+
+#define SNAPSHOT_VERSION 1
+#define RECORDING_VERSION 2
+
+//Everything needed to resume a game without replaying it
+struct Snapshot
+{
+    Position position_;
+    unsigned char gameState_;
+    unsigned char previousGameState_;
+    unsigned char startGameState_;
+    unsigned char selectionMode_;
+    unsigned char musicState_;
+    unsigned char previousMusicState_;
+    float musicGain_;
+    float cameraYaw_;
+    float cameraPitch_;
+    float cameraDistance_;
+    unsigned seed_;
+};
+
+class SaveMaster : public Master
+{
+    URHO3D_OBJECT(SaveMaster, Master);
+public:
+    SaveMaster(Context* context);
+
+    void Save(const Snapshot& snapshot);
+    bool Load(Snapshot& snapshot);
+    void Flush();
+
+    void SaveRecording(const Recording& recording);
+    bool LoadRecording(const String& fileName, Recording& recording);
+private:
+    String fileName_;
+    Mutex bufferMutex_;
+    Mutex fileMutex_;
+    VectorBuffer pending_;
+    unsigned pendingSequence_;
+    unsigned writtenSequence_;
+
+    static void WriteSnapshot(const WorkItem* item, unsigned threadIndex);
+    void Write();
+    static void SyncToDisk(File& file);
+};
+
+#endif // SAVEMASTER_H
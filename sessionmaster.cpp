@@ -0,0 +1,426 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "sessionmaster.h"
+#include "capturemaster.h"
+
+#include <Urho3D/Input/InputEvents.h>
+
+SessionMaster::SessionMaster(Context* context) : Master(context),
+    fileName_{},
+    recording_{MC->IsRecordingInput()},
+    playing_{MC->IsPlayingInput()},
+    log_{},
+    frame_{},
+    frameEvents_{0},
+    numFrames_{0},
+    nextTimeStep_{0.0f},
+    pendingEvents_{0},
+    finished_{false},
+    playTimer_{},
+    mousePosition_{},
+    mouseMove_{},
+    qualifiers_{0},
+    numJoysticks_{0},
+    axes_{}
+{
+    if (playing_){
+
+        fileName_ = GetPlayFile(GetArguments());
+
+    } else if (recording_){
+
+        String folder{FILES->GetAppPreferencesDir("luckey", "quatter") + "Sessions/"};
+        FILES->CreateDir(folder);
+        fileName_ = folder + "Session_" + Time::GetTimeStamp().Replaced(':', '_').Replaced('.', '_').Replaced(' ', '_') + ".qses";
+    }
+}
+
+bool SessionMaster::IsRecordRequested(const Vector<String>& arguments)
+{
+    for (const String& argument : arguments)
+        if (argument.ToLower() == SESSION_RECORD_ARGUMENT)
+            return true;
+
+    return false;
+}
+String SessionMaster::GetPlayFile(const Vector<String>& arguments)
+{
+    for (unsigned a{0}; a + 1 < arguments.Size(); ++a)
+        if (arguments[a].ToLower() == SESSION_PLAY_ARGUMENT)
+            return arguments[a + 1];
+
+    return String::EMPTY;
+}
+bool SessionMaster::LoadHeader(Context* context, const String& fileName, SessionHeader& header)
+{
+    File file{context, fileName, FILE_READ};
+    return file.IsOpen() && ReadHeader(file, header);
+}
+bool SessionMaster::ReadHeader(Deserializer& source, SessionHeader& header)
+{
+    if (source.ReadFileID() != "QSES"
+     || source.ReadUByte() != SESSION_VERSION)
+        return false;
+
+    header.seed_ = source.ReadUInt();
+    header.width_ = source.ReadUShort();
+    header.height_ = source.ReadUShort();
+    header.mousePosition_ = source.ReadIntVector2();
+    header.numJoysticks_ = source.ReadUByte();
+
+    return true;
+}
+
+void SessionMaster::Start()
+{
+    if (playing_)
+        StartPlaying();
+    else if (recording_)
+        StartRecording();
+}
+void SessionMaster::StartRecording()
+{
+    log_.Clear();
+    log_.WriteFileID("QSES");
+    log_.WriteUByte(SESSION_VERSION);
+    log_.WriteUInt(MC->GetSessionSeed());
+    log_.WriteUShort(GRAPHICS->GetWidth());
+    log_.WriteUShort(GRAPHICS->GetHeight());
+    log_.WriteIntVector2(INPUT->GetMousePosition());
+    log_.WriteUByte(INPUT->GetNumJoysticks());
+
+    //Only what the devices send, not what a playback would
+    for (StringHash eventType : {E_MOUSEMOVE, E_MOUSEBUTTONDOWN, E_MOUSEBUTTONUP, E_MOUSEWHEEL,
+                                 E_KEYDOWN, E_KEYUP,
+                                 E_JOYSTICKBUTTONDOWN, E_JOYSTICKBUTTONUP, E_JOYSTICKAXISMOVE,
+                                 E_JOYSTICKCONNECTED, E_JOYSTICKDISCONNECTED})
+        SubscribeToEvent(INPUT, eventType, URHO3D_HANDLER(SessionMaster, HandleInput));
+
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(SessionMaster, HandleBeginFrame));
+
+    Log::Write(LOG_INFO, "Recording input to " + fileName_);
+}
+void SessionMaster::StartPlaying()
+{
+    SessionHeader header{};
+    File file{context_, fileName_, FILE_READ};
+    if (file.IsOpen())
+        log_.SetData(file, file.GetSize());
+
+    if (!ReadHeader(log_, header)){
+
+        Log::Write(LOG_ERROR, "Could not load input session " + fileName_);
+        Finish();
+        return;
+    }
+
+    if (header.width_ != GRAPHICS->GetWidth() || header.height_ != GRAPHICS->GetHeight())
+        Log::Write(LOG_WARNING, "Session was recorded at " + String(header.width_) + "x" + String(header.height_)
+                              + ", the cursor may not land where it did");
+
+    mousePosition_ = header.mousePosition_;
+    numJoysticks_ = header.numJoysticks_;
+    finished_ = !ReadFrame();
+
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(SessionMaster, HandleBeginFrame));
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(SessionMaster, HandleEndFrame));
+    ENGINE->SetNextTimeStep(nextTimeStep_);
+    playTimer_.Reset();
+
+    Log::Write(LOG_INFO, "Playing input session " + fileName_);
+}
+//Writes the log of a recording session, the unfinished frame is left out
+void SessionMaster::Stop()
+{
+    if (!recording_)
+        return;
+
+    recording_ = false;
+    UnsubscribeFromAllEvents();
+
+    File file{context_, fileName_, FILE_WRITE};
+    if (!file.IsOpen() || file.Write(log_.GetData(), log_.GetSize()) != log_.GetSize()){
+
+        Log::Write(LOG_ERROR, "Could not write input session " + fileName_);
+        return;
+    }
+    Log::Write(LOG_INFO, "Recorded " + String(numFrames_) + " frames of input to " + fileName_);
+}
+void SessionMaster::Finish()
+{
+    UnsubscribeFromAllEvents();
+
+    if (numFrames_){
+
+        float milliseconds{playTimer_.GetUSec(false) * 0.001f};
+        Log::Write(LOG_INFO, "Played " + String(numFrames_) + " frames of input in " + String(milliseconds) + " ms, "
+                           + String(milliseconds / numFrames_) + " ms per frame");
+    }
+    GetSubsystem<CaptureMaster>()->Finish();
+    ENGINE->Exit();
+}
+
+IntVector2 SessionMaster::GetMousePosition() const
+{
+    return playing_ ? mousePosition_ : INPUT->GetMousePosition();
+}
+IntVector2 SessionMaster::GetMouseMove() const
+{
+    return playing_ ? mouseMove_ : INPUT->GetMouseMove();
+}
+bool SessionMaster::GetQualifierDown(int qualifier) const
+{
+    return playing_ ? (qualifiers_ & qualifier) != 0 : INPUT->GetQualifierDown(qualifier);
+}
+unsigned SessionMaster::GetNumJoysticks() const
+{
+    return playing_ ? numJoysticks_ : INPUT->GetNumJoysticks();
+}
+bool SessionMaster::HasJoystick(int index) const
+{
+    if (index < 0)
+        return false;
+    else if (playing_)
+        return static_cast<unsigned>(index) < numJoysticks_;
+    else
+        return INPUT->GetJoystickByIndex(index) != nullptr;
+}
+float SessionMaster::GetAxisPosition(int joystick, int axis) const
+{
+    if (joystick < 0 || axis < 0)
+        return 0.0f;
+
+    if (playing_)
+        return joystick < SESSION_JOYSTICKS && axis < SESSION_AXES ? axes_[joystick][axis] : 0.0f;
+
+    JoystickState* state{INPUT->GetJoystickByIndex(joystick)};
+    return state ? state->GetAxisPosition(axis) : 0.0f;
+}
+
+void SessionMaster::WriteEvent(SessionEvent type)
+{
+    frame_.WriteUByte(type);
+    ++frameEvents_;
+}
+//Each frame holds its timestep, its number of events and then the events
+bool SessionMaster::ReadFrame()
+{
+    if (log_.IsEof())
+        return false;
+
+    nextTimeStep_ = log_.ReadFloat();
+    pendingEvents_ = log_.ReadVLE();
+    return true;
+}
+
+void SessionMaster::HandleInput(StringHash eventType, VariantMap& eventData)
+{
+    if (eventType == E_MOUSEMOVE){
+
+        using namespace MouseMove;
+        WriteEvent(SE_MOUSEMOVE);
+        frame_.WriteShort(eventData[P_X].GetInt());
+        frame_.WriteShort(eventData[P_Y].GetInt());
+        frame_.WriteShort(eventData[P_DX].GetInt());
+        frame_.WriteShort(eventData[P_DY].GetInt());
+        frame_.WriteUByte(eventData[P_BUTTONS].GetInt());
+        frame_.WriteUByte(eventData[P_QUALIFIERS].GetInt());
+
+    } else if (eventType == E_MOUSEBUTTONDOWN || eventType == E_MOUSEBUTTONUP){
+
+        using namespace MouseButtonDown;
+        WriteEvent(eventType == E_MOUSEBUTTONDOWN ? SE_MOUSEBUTTONDOWN : SE_MOUSEBUTTONUP);
+        frame_.WriteUByte(eventData[P_BUTTON].GetInt());
+        frame_.WriteUByte(eventData[P_BUTTONS].GetInt());
+        frame_.WriteUByte(eventData[P_QUALIFIERS].GetInt());
+
+    } else if (eventType == E_MOUSEWHEEL){
+
+        using namespace MouseWheel;
+        WriteEvent(SE_MOUSEWHEEL);
+        frame_.WriteByte(Clamp(eventData[P_WHEEL].GetInt(), -128, 127));
+        frame_.WriteUByte(eventData[P_BUTTONS].GetInt());
+        frame_.WriteUByte(eventData[P_QUALIFIERS].GetInt());
+
+    } else if (eventType == E_KEYDOWN || eventType == E_KEYUP){
+
+        using namespace KeyDown;
+        WriteEvent(eventType == E_KEYDOWN ? SE_KEYDOWN : SE_KEYUP);
+        frame_.WriteInt(eventData[P_KEY].GetInt());
+        frame_.WriteVLE(eventData[P_SCANCODE].GetInt());
+        frame_.WriteUByte(eventData[P_BUTTONS].GetInt());
+        frame_.WriteUByte(eventData[P_QUALIFIERS].GetInt());
+        if (eventType == E_KEYDOWN)
+            frame_.WriteBool(eventData[P_REPEAT].GetBool());
+
+    } else if (eventType == E_JOYSTICKBUTTONDOWN || eventType == E_JOYSTICKBUTTONUP){
+
+        using namespace JoystickButtonDown;
+        WriteEvent(eventType == E_JOYSTICKBUTTONDOWN ? SE_JOYSTICKBUTTONDOWN : SE_JOYSTICKBUTTONUP);
+        frame_.WriteUByte(eventData[P_JOYSTICKID].GetInt());
+        frame_.WriteUByte(eventData[P_BUTTON].GetInt());
+
+    } else if (eventType == E_JOYSTICKAXISMOVE){
+
+        using namespace JoystickAxisMove;
+        WriteEvent(SE_JOYSTICKAXISMOVE);
+        frame_.WriteUByte(eventData[P_JOYSTICKID].GetInt());
+        frame_.WriteUByte(eventData[P_AXIS].GetInt());
+        frame_.WriteFloat(eventData[P_POSITION].GetFloat());
+
+    } else if (eventType == E_JOYSTICKCONNECTED || eventType == E_JOYSTICKDISCONNECTED){
+
+        using namespace JoystickConnected;
+        WriteEvent(eventType == E_JOYSTICKCONNECTED ? SE_JOYSTICKCONNECTED : SE_JOYSTICKDISCONNECTED);
+        frame_.WriteUByte(eventData[P_JOYSTICKID].GetInt());
+    }
+}
+//Sends the next event of the log as if it came from the devices
+void SessionMaster::PlayEvent()
+{
+    VariantMap& eventData{GetEventDataMap()};
+    SessionEvent type{static_cast<SessionEvent>(log_.ReadUByte())};
+
+    switch (type){
+    case SE_MOUSEMOVE: {
+        using namespace MouseMove;
+        mousePosition_.x_ = log_.ReadShort();
+        mousePosition_.y_ = log_.ReadShort();
+        eventData[P_X] = mousePosition_.x_;
+        eventData[P_Y] = mousePosition_.y_;
+        eventData[P_DX] = log_.ReadShort();
+        eventData[P_DY] = log_.ReadShort();
+        eventData[P_BUTTONS] = log_.ReadUByte();
+        qualifiers_ = log_.ReadUByte();
+        eventData[P_QUALIFIERS] = qualifiers_;
+        SendEvent(E_MOUSEMOVE, eventData);
+    } break;
+    case SE_MOUSEBUTTONDOWN: case SE_MOUSEBUTTONUP: {
+        using namespace MouseButtonDown;
+        eventData[P_BUTTON] = log_.ReadUByte();
+        eventData[P_BUTTONS] = log_.ReadUByte();
+        qualifiers_ = log_.ReadUByte();
+        eventData[P_QUALIFIERS] = qualifiers_;
+        SendEvent(type == SE_MOUSEBUTTONDOWN ? E_MOUSEBUTTONDOWN : E_MOUSEBUTTONUP, eventData);
+    } break;
+    case SE_MOUSEWHEEL: {
+        using namespace MouseWheel;
+        eventData[P_WHEEL] = log_.ReadByte();
+        eventData[P_BUTTONS] = log_.ReadUByte();
+        qualifiers_ = log_.ReadUByte();
+        eventData[P_QUALIFIERS] = qualifiers_;
+        SendEvent(E_MOUSEWHEEL, eventData);
+    } break;
+    case SE_KEYDOWN: case SE_KEYUP: {
+        using namespace KeyDown;
+        eventData[P_KEY] = log_.ReadInt();
+        eventData[P_SCANCODE] = static_cast<int>(log_.ReadVLE());
+        eventData[P_BUTTONS] = log_.ReadUByte();
+        qualifiers_ = log_.ReadUByte();
+        eventData[P_QUALIFIERS] = qualifiers_;
+        if (type == SE_KEYDOWN){
+
+            eventData[P_REPEAT] = log_.ReadBool();
+            SendEvent(E_KEYDOWN, eventData);
+
+        } else SendEvent(E_KEYUP, eventData);
+    } break;
+    case SE_JOYSTICKBUTTONDOWN: case SE_JOYSTICKBUTTONUP: {
+        using namespace JoystickButtonDown;
+        eventData[P_JOYSTICKID] = log_.ReadUByte();
+        eventData[P_BUTTON] = log_.ReadUByte();
+        SendEvent(type == SE_JOYSTICKBUTTONDOWN ? E_JOYSTICKBUTTONDOWN : E_JOYSTICKBUTTONUP, eventData);
+    } break;
+    case SE_JOYSTICKAXISMOVE: {
+        using namespace JoystickAxisMove;
+        int joystick{log_.ReadUByte()};
+        int axis{log_.ReadUByte()};
+        float position{log_.ReadFloat()};
+        if (joystick < SESSION_JOYSTICKS && axis < SESSION_AXES)
+            axes_[joystick][axis] = position;
+
+        eventData[P_JOYSTICKID] = joystick;
+        eventData[P_AXIS] = axis;
+        eventData[P_POSITION] = position;
+        SendEvent(E_JOYSTICKAXISMOVE, eventData);
+    } break;
+    case SE_JOYSTICKCONNECTED: case SE_JOYSTICKDISCONNECTED: {
+        using namespace JoystickConnected;
+        if (type == SE_JOYSTICKCONNECTED)
+            ++numJoysticks_;
+        else if (numJoysticks_)
+            --numJoysticks_;
+
+        eventData[P_JOYSTICKID] = log_.ReadUByte();
+        SendEvent(type == SE_JOYSTICKCONNECTED ? E_JOYSTICKCONNECTED : E_JOYSTICKDISCONNECTED, eventData);
+    } break;
+    case SE_FRAMEMOUSEMOVE: {
+        mouseMove_.x_ = log_.ReadShort();
+        mouseMove_.y_ = log_.ReadShort();
+    } break;
+    default: {
+        //Unknown events leave the rest of the log unreadable
+        Log::Write(LOG_ERROR, "Corrupt input session " + fileName_);
+        pendingEvents_ = 1;
+        log_.Seek(log_.GetSize());
+    } break;
+    }
+}
+
+//Input sends the events of a frame before this, so the frame is complete here
+void SessionMaster::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{ (void)eventType;
+
+    if (recording_){
+
+        //Polled once per frame, as InputMaster reads it
+        IntVector2 mouseMove{INPUT->GetMouseMove()};
+        if (mouseMove != IntVector2::ZERO){
+
+            WriteEvent(SE_FRAMEMOUSEMOVE);
+            frame_.WriteShort(mouseMove.x_);
+            frame_.WriteShort(mouseMove.y_);
+        }
+
+        log_.WriteFloat(eventData[BeginFrame::P_TIMESTEP].GetFloat());
+        log_.WriteVLE(frameEvents_);
+        log_.Write(frame_.GetData(), frame_.GetSize());
+        frame_.Clear();
+        frameEvents_ = 0;
+        ++numFrames_;
+
+    } else if (playing_ && !finished_){
+
+        mouseMove_ = IntVector2::ZERO;
+        for (; pendingEvents_ > 0; --pendingEvents_)
+            PlayEvent();
+
+        ++numFrames_;
+        finished_ = !ReadFrame();
+    }
+}
+//The next frame gets the timestep it had when it was recorded, however long this one took
+void SessionMaster::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    if (finished_)
+        Finish();
+    else
+        ENGINE->SetNextTimeStep(nextTimeStep_);
+}
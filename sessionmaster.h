@@ -0,0 +1,112 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SESSIONMASTER_H
+#define SESSIONMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+
+#include "master.h"
+
+#define SESSION_RECORD_ARGUMENT "-recordinput"
+#define SESSION_PLAY_ARGUMENT "--playinput"
+#define SESSION_VERSION 1
+#define SESSION_JOYSTICKS 4
+#define SESSION_AXES 16
+
+enum SessionEvent{SE_MOUSEMOVE, SE_MOUSEBUTTONDOWN, SE_MOUSEBUTTONUP, SE_MOUSEWHEEL,
+                  SE_KEYDOWN, SE_KEYUP,
+                  SE_JOYSTICKBUTTONDOWN, SE_JOYSTICKBUTTONUP, SE_JOYSTICKAXISMOVE,
+                  SE_JOYSTICKCONNECTED, SE_JOYSTICKDISCONNECTED,
+                  SE_FRAMEMOUSEMOVE, SE_ALL};
+
+//What a session needs to start out the same as when it was recorded
+struct SessionHeader
+{
+    unsigned seed_;
+    int width_;
+    int height_;
+    IntVector2 mousePosition_;
+    unsigned numJoysticks_;
+};
+
+//Logs the device events InputMaster listens to, frame by frame with the
+//timestep of each frame, or sends them again from a log in their place.
+//Played back at the recorded timesteps with the recorded seed, a session
+//makes the same selections, puts and camera moves as the player did.
+//InputMaster reads polled input through here so it follows the log as well.
+//
+//Usage: quatter -recordinput
+//       quatter --playinput Session.qses
+class SessionMaster : public Master
+{
+    URHO3D_OBJECT(SessionMaster, Master);
+public:
+    SessionMaster(Context* context);
+
+    static bool IsRecordRequested(const Vector<String>& arguments);
+    static String GetPlayFile(const Vector<String>& arguments);
+    static bool LoadHeader(Context* context, const String& fileName, SessionHeader& header);
+
+    void Start();
+    void Stop();
+    bool IsRecording() const { return recording_; }
+    bool IsPlaying() const { return playing_; }
+
+    IntVector2 GetMousePosition() const;
+    IntVector2 GetMouseMove() const;
+    bool GetQualifierDown(int qualifier) const;
+    unsigned GetNumJoysticks() const;
+    bool HasJoystick(int index) const;
+    float GetAxisPosition(int joystick, int axis) const;
+private:
+    String fileName_;
+    bool recording_;
+    bool playing_;
+    VectorBuffer log_;
+    VectorBuffer frame_;
+    unsigned frameEvents_;
+    unsigned numFrames_;
+
+    float nextTimeStep_;
+    unsigned pendingEvents_;
+    bool finished_;
+    HiresTimer playTimer_;
+
+    IntVector2 mousePosition_;
+    IntVector2 mouseMove_;
+    int qualifiers_;
+    unsigned numJoysticks_;
+    float axes_[SESSION_JOYSTICKS][SESSION_AXES];
+
+    static bool ReadHeader(Deserializer& source, SessionHeader& header);
+    void StartRecording();
+    void StartPlaying();
+    void WriteEvent(SessionEvent type);
+    bool ReadFrame();
+    void PlayEvent();
+    void Finish();
+
+    void HandleInput(StringHash eventType, VariantMap& eventData);
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+};
+
+#endif // SESSIONMASTER_H
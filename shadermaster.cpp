@@ -0,0 +1,43 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "shadermaster.h"
+
+ShaderMaster::ShaderMaster(Context* context) : Master(context),
+    fileName_{FILES->GetAppPreferencesDir("luckey", "quatter") + "Shaders" + GRAPHICS->GetApiName() + ".xml"}
+{
+}
+
+//Compiles what earlier sessions used and keeps adding new combinations to the list
+void ShaderMaster::Precache()
+{
+    if (FILES->FileExists(fileName_)){
+
+        HiresTimer timer{};
+        File file{context_, fileName_};
+        GRAPHICS->PrecacheShaders(file);
+
+        Log::Write(LOG_INFO, "Precached shaders in " + String(timer.GetUSec(false) / 1000) + " ms");
+    }
+
+    GRAPHICS->BeginDumpShaders(fileName_);
+}
+void ShaderMaster::Save()
+{
+    GRAPHICS->EndDumpShaders();
+}
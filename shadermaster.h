@@ -0,0 +1,43 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SHADERMASTER_H
+#define SHADERMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/IO/File.h>
+
+#include "master.h"
+
+//Remembers every shader combination the game has drawn with, per graphics API,
+//and compiles and links all of them while loading. Effects that only show up
+//late in a game, like the Quatter glow, then no longer stall their first frame.
+class ShaderMaster : public Master
+{
+    URHO3D_OBJECT(ShaderMaster, Master);
+public:
+    ShaderMaster(Context* context);
+
+    void Precache();
+    void Save();
+private:
+    String fileName_;
+};
+
+#endif // SHADERMASTER_H
@@ -0,0 +1,215 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "shadowmaster.h"
+#include "qualitymaster.h"
+
+ShadowMaster::ShadowMaster(Context* context) : Master(context),
+    lights_{},
+    pieces_{},
+    tableInverse_{},
+    tableRect_{},
+    tableTop_{}
+{
+}
+
+void ShadowMaster::Bake()
+{
+    lights_.Clear();
+    pieces_.Clear();
+
+    Scene* scene{MC->world_.scene_};
+    Node* tableNode{scene->GetChild("Table")};
+    StaticModel* tableModel{tableNode ? tableNode->GetComponent<StaticModel>() : nullptr};
+    if (!tableModel)
+        return;
+
+    //The table top as a rectangle in the space of the table, which only turns around its up axis
+    const BoundingBox& tableBox{tableModel->GetBoundingBox()};
+    tableInverse_ = tableNode->GetWorldTransform().Inverse();
+    tableRect_ = Rect(tableBox.min_.x_, tableBox.min_.z_, tableBox.max_.x_, tableBox.max_.z_);
+    tableTop_ = tableModel->GetWorldBoundingBox().max_.y_;
+
+    PODVector<Light*> lights{};
+    scene->GetComponents<Light>(lights, true);
+    for (Light* light : lights){
+
+        Vector3 position{light->GetNode()->GetWorldPosition()};
+        if (light->GetLightType() == LIGHT_DIRECTIONAL
+         || !light->GetCastShadows()
+         || position.y_ >= tableTop_
+         || lights_.Size() == 8)
+            continue;
+
+        BakedLight baked{WeakPtr<Light>(light), position, 0x80000000u >> lights_.Size(), 0};
+        lights_.Push(baked);
+
+        light->SetLightMask(baked.mask_);
+    }
+
+    if (lights_.Empty())
+        return;
+
+    PODVector<Drawable*> drawables{};
+    scene->GetDerivedComponents<Drawable>(drawables, true);
+    for (Drawable* drawable : drawables){
+
+        //The table does not shade itself and the sky is unlit
+        if (!(drawable->GetDrawableFlags() & DRAWABLE_GEOMETRY)
+         || drawable->GetNode() == tableNode
+         || drawable->IsInstanceOf<Skybox>())
+            continue;
+
+        unsigned partialMask{Classify(drawable)};
+        Count(0, partialMask);
+
+        if (drawable->GetNode()->HasTag("Piece")){
+
+            MovingCaster piece{};
+            piece.drawable_ = drawable;
+            piece.lastPosition_ = drawable->GetNode()->GetWorldPosition();
+            piece.partialMask_ = partialMask;
+            pieces_.Push(piece);
+        }
+    }
+
+    unsigned shadowed{0};
+    for (const BakedLight& light : lights_)
+        if (light.partial_)
+            ++shadowed;
+
+    SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(ShadowMaster, HandlePostUpdate));
+    Log::Write(LOG_INFO, "Baked table occlusion for " + String(lights_.Size()) + " lights, "
+                       + String(shadowed) + " of them still need shadows");
+}
+
+//Lights that were not baked always do
+bool ShadowMaster::NeedsShadows(Light* light) const
+{
+    for (const BakedLight& baked : lights_)
+        if (baked.light_ == light)
+            return baked.partial_ > 0;
+
+    return true;
+}
+
+//For how many corners of the box the table top lies between them and the light
+ShadowMaster::Occlusion ShadowMaster::Occluded(const Vector3& light, const BoundingBox& box) const
+{
+    int covered{0};
+    for (int c{0}; c < 8; ++c){
+
+        Vector3 corner{c & 1 ? box.max_.x_ : box.min_.x_,
+                       c & 2 ? box.max_.y_ : box.min_.y_,
+                       c & 4 ? box.max_.z_ : box.min_.z_};
+
+        if (corner.y_ < tableTop_ - TABLE_TOP_EPSILON)
+            continue;
+
+        float t{corner.y_ > tableTop_ ? (tableTop_ - light.y_) / (corner.y_ - light.y_) : 1.0f};
+        Vector3 crossing{tableInverse_ * (light + (corner - light) * t)};
+
+        if (tableRect_.IsInside(Vector2(crossing.x_, crossing.z_)) != OUTSIDE)
+            ++covered;
+    }
+
+    if (covered == 8)
+        return OCCLUSION_FULL;
+    else if (covered)
+        return OCCLUSION_PARTIAL;
+    else
+        return OCCLUSION_NONE;
+}
+//Masks out the lights the table hides the drawable from and returns
+//the mask bits of those it reaches only part of
+unsigned ShadowMaster::Classify(Drawable* drawable)
+{
+    unsigned lightMask{drawable->GetLightMask()};
+    unsigned partialMask{0};
+    const BoundingBox& box{drawable->GetWorldBoundingBox()};
+
+    for (const BakedLight& light : lights_){
+
+        Occlusion occlusion{Occluded(light.position_, box)};
+        if (occlusion == OCCLUSION_FULL){
+
+            lightMask &= ~light.mask_;
+
+        } else {
+
+            lightMask |= light.mask_;
+            //A mask can't light only part of it
+            if (occlusion == OCCLUSION_PARTIAL)
+                partialMask |= light.mask_;
+        }
+    }
+
+    if (lightMask != drawable->GetLightMask())
+        drawable->SetLightMask(lightMask);
+
+    return partialMask;
+}
+//Moves a drawable's partial lights from one mask to the other,
+//true when any light starts or stops needing shadows
+bool ShadowMaster::Count(unsigned before, unsigned after)
+{
+    bool changed{false};
+    for (BakedLight& light : lights_){
+
+        bool was{(before & light.mask_) != 0};
+        bool is{(after & light.mask_) != 0};
+        if (was == is)
+            continue;
+
+        if (is && light.partial_++ == 0)
+            changed = true;
+        else if (!is && --light.partial_ == 0)
+            changed = true;
+    }
+
+    return changed;
+}
+
+void ShadowMaster::HandlePostUpdate(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    URHO3D_PROFILE(ShadowMasks);
+
+    bool changed{false};
+    for (MovingCaster& piece : pieces_){
+
+        Drawable* drawable{piece.drawable_};
+        if (!drawable)
+            continue;
+
+        Vector3 position{drawable->GetNode()->GetWorldPosition()};
+        if (position != piece.lastPosition_){
+
+            piece.lastPosition_ = position;
+
+            unsigned partialMask{Classify(drawable)};
+            if (Count(piece.partialMask_, partialMask))
+                changed = true;
+
+            piece.partialMask_ = partialMask;
+        }
+    }
+
+    if (changed)
+        GetSubsystem<QualityMaster>()->ApplyShadows();
+}
@@ -0,0 +1,71 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SHADOWMASTER_H
+#define SHADOWMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include "master.h"
+
+#define TABLE_TOP_EPSILON 0.05f
+
+//Lights below the table top only reach what the table does not cover.
+//That occlusion is worked out once into light masks instead of rendering
+//their cube shadow maps every frame. Only pieces are classified again,
+//and only after they moved. A light needs its shadow map back for as long
+//as it reaches part of anything that the table also partly covers.
+//Whether shadows are drawn is left to the QualityMaster.
+class ShadowMaster : public Master
+{
+    URHO3D_OBJECT(ShadowMaster, Master);
+public:
+    ShadowMaster(Context* context);
+
+    void Bake();
+    unsigned GetNumBakedLights() const { return lights_.Size(); }
+    bool NeedsShadows(Light* light) const;
+private:
+    enum Occlusion{OCCLUSION_NONE, OCCLUSION_PARTIAL, OCCLUSION_FULL};
+
+    struct BakedLight
+    {
+        WeakPtr<Light> light_;
+        Vector3 position_;
+        unsigned mask_;
+        unsigned partial_;  //Drawables it reaches only part of
+    };
+    struct MovingCaster
+    {
+        WeakPtr<Drawable> drawable_;
+        Vector3 lastPosition_;
+        unsigned partialMask_;
+    };
+
+    Vector<BakedLight> lights_;
+    Vector<MovingCaster> pieces_;
+    Matrix3x4 tableInverse_;
+    Rect tableRect_;
+    float tableTop_;
+
+    Occlusion Occluded(const Vector3& light, const BoundingBox& box) const;
+    unsigned Classify(Drawable* drawable);
+    bool Count(unsigned before, unsigned after);
+    void HandlePostUpdate(StringHash eventType, VariantMap& eventData);
+};
+
+#endif // SHADOWMASTER_H
@@ -18,6 +18,7 @@
 
 #include "square.h"
 #include "piece.h"
+#include "lightmaster.h"
 
 void Square::RegisterObject(Context *context)
 {
@@ -35,17 +36,17 @@ void Square::OnNodeSet(Node *node)
     StringVector tag{}; tag.Push(String("Square"));
     node_->SetTags(tag);
     StaticModel* touchPlane{node_->CreateComponent<StaticModel>()};
-    touchPlane->SetModel(MC->GetModel("Plane"));
-    touchPlane->SetMaterial(MC->GetMaterial("Invisible"));
+    touchPlane->SetModel(MC->GetModel(MDL_PLANE));
+    touchPlane->SetMaterial(MC->GetMaterial(MAT_INVISIBLE));
     free_ = true;
     piece_ = nullptr;
     //Create slot
     Node* slotNode{node_->CreateChild("Slot")};
     slotNode->SetPosition(Vector3::UP * 0.05f);
-    slot_ = slotNode->CreateComponent<AnimatedModel>();
-    slot_->SetModel(MC->GetModel("Slot"));
-    slot_->SetMaterial(MC->GetMaterial("Glow")->Clone());
-    slot_->GetMaterial()->SetShaderParameter("MatDiffColor", Color(0.0f, 0.0f, 0.0f, 0.0f));
+    slot_ = slotNode->CreateComponent<GlowModel>();
+    slot_->SetPulsingModel(MC->GetModel(MDL_SLOT));
+    slot_->SetMaterial(MC->GetMaterial(MAT_GLOW_PULSE));
+    slot_->SetColor(Color(0.0f, 0.0f, 0.0f, 0.0f));
     //Create light
     Node* lightNode{slotNode->CreateChild("Light")};
     lightNode->SetPosition(Vector3::UP * 0.23f);
@@ -54,4 +55,5 @@ void Square::OnNodeSet(Node *node)
     light_->SetBrightness(0.023f);
     light_->SetRange(2.0f);
     light_->SetCastShadows(false);
+    LIGHTS->Register(light_, 0.5f);
 }
@@ -22,6 +22,7 @@
 #include <Urho3D/Urho3D.h>
 
 #include "luckey.h"
+#include "glowmodel.h"
 
 class Piece;
 
@@ -33,10 +34,11 @@ public:
     Square(Context* context);
     static void RegisterObject(Context* context);
     virtual void OnNodeSet(Node* node);
+    bool IsFree() const { return free_; }
 
 private:
     IntVector2 coords_;
-    SharedPtr<AnimatedModel> slot_;
+    SharedPtr<GlowModel> slot_;
     SharedPtr<Light> light_;
     Piece* piece_;
     bool free_;
@@ -0,0 +1,410 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "tournament.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <thread>
+
+Tournament::Tournament(const TournamentSettings& settings, const std::vector<std::string>& specs):
+    settings_{settings},
+    specs_{specs},
+    names_{},
+    pairings_{},
+    openings_{},
+    games_{},
+    nextGame_{0},
+    played_{0},
+    threadsPerGame_{1},
+    mutex_{},
+    record_{}
+{
+}
+
+bool Tournament::Run()
+{
+    for (const std::string& spec : specs_){
+
+        std::unique_ptr<Player> player{Player::Create(spec)};
+        if (!player){
+            std::fprintf(stderr, "Unknown player configuration: %s\n", spec.c_str());
+            return false;
+        }
+        names_.push_back(player->GetName());
+        threadsPerGame_ = std::max(threadsPerGame_, player->GetNumThreads());
+    }
+
+    if (!settings_.recordFile_.empty()){
+        record_.open(settings_.recordFile_);
+        if (!record_.is_open()){
+            std::fprintf(stderr, "Could not open %s\n", settings_.recordFile_.c_str());
+            return false;
+        }
+    }
+
+    CreatePairings();
+    CreateOpenings();
+
+    //Give each game its own set of cores so that no engine gets more CPU than another
+    int cores{std::max(1, static_cast<int>(std::thread::hardware_concurrency()))};
+    int workers{settings_.workers_ > 0 ? settings_.workers_
+                                       : std::max(1, cores / threadsPerGame_)};
+
+    std::printf("%d games on %d workers, %d thread(s) per game\n",
+                static_cast<int>(games_.size()), workers, threadsPerGame_);
+
+    std::vector<std::thread> threads{};
+    for (int w{0}; w < workers; ++w)
+        threads.push_back(std::thread(&Tournament::Work, this, w));
+    for (std::thread& thread : threads)
+        thread.join();
+
+    Report();
+    return true;
+}
+
+void Tournament::CreatePairings()
+{
+    int numPlayers{static_cast<int>(names_.size())};
+    for (int i{0}; i < numPlayers; ++i){
+        //A gauntlet only pits the first configuration against the others
+        for (int j{i + 1}; j < numPlayers; ++j)
+            pairings_.push_back(Pairing{i, j, 0, 0, 0, 0, ""});
+
+        if (settings_.gauntlet_)
+            break;
+    }
+
+    //Seeds are drawn up front so results do not depend on which worker plays a game
+    RandomStream seeds{settings_.seed_};
+    for (int o{0}; o < settings_.openings_; ++o)
+        for (size_t p{0}; p < pairings_.size(); ++p)
+            for (bool swapped : {false, true}){
+
+                games_.push_back(Game{static_cast<int>(p), o, swapped, seeds.Fork()});
+                ++pairings_[p].pending_;
+            }
+}
+
+//Random positions a few actions in, distinct up to board symmetry and attribute inversion
+void Tournament::CreateOpenings()
+{
+    RandomStream random{settings_.seed_ ^ 0x5eed0000u};
+    std::set<uint64_t> seen{};
+    int attempts{0};
+
+    while (static_cast<int>(openings_.size()) < settings_.openings_){
+
+        Position opening{Position::Start()};
+        for (int ply{0}; ply < settings_.openingPlies_ && !opening.IsOver(); ++ply){
+
+            if (opening.InPickState()){
+
+                std::vector<int> pieces{};
+                for (int p{0}; p < POSITION_PIECES; ++p)
+                    if (opening.IsFree(p) && !opening.GivesQuatter(p))
+                        pieces.push_back(p);
+
+                if (pieces.empty())
+                    break;
+                opening.Pick(pieces[random.Int(static_cast<int>(pieces.size()))]);
+            } else {
+
+                std::vector<int> squares{};
+                for (int s{0}; s < POSITION_SQUARES; ++s)
+                    if (opening.squares_[s] == NO_PIECE && opening.WinningLine(s, opening.picked_) < 0)
+                        squares.push_back(s);
+
+                if (squares.empty())
+                    break;
+                opening.Put(squares[random.Int(static_cast<int>(squares.size()))]);
+            }
+        }
+
+        //Allow repeats once the distinct openings run out
+        if (seen.insert(opening.CanonicalKey()).second || ++attempts > 1000)
+            openings_.push_back(opening);
+    }
+}
+
+void Tournament::Work(int worker)
+{
+    int cores{std::max(1, static_cast<int>(std::thread::hardware_concurrency()))};
+    std::vector<int> cpus{};
+    if (threadsPerGame_ * (worker + 1) <= cores)
+        for (int c{0}; c < threadsPerGame_; ++c)
+            cpus.push_back(worker * threadsPerGame_ + c);
+
+    PinCurrentThread(cpus);
+
+    std::vector<std::unique_ptr<Player>> players{};
+    for (const std::string& spec : specs_){
+        players.push_back(Player::Create(spec));
+        players.back()->SetCpus(cpus);
+    }
+
+    while (true){
+
+        Game game{};
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+
+            while (nextGame_ < games_.size() && !pairings_[games_[nextGame_].pairing_].verdict_.empty())
+                ++nextGame_;
+
+            if (nextGame_ == games_.size())
+                return;
+
+            game = games_[nextGame_++];
+        }
+
+        const Pairing& pairing{pairings_[game.pairing_]};
+        std::string moves{};
+        int result{PlayGame(game,
+                            players[pairing.first_].get(),
+                            players[pairing.second_].get(),
+                            moves)};
+        Finish(game, result, moves);
+    }
+}
+
+//Returns 1, 0 or -1 from the point of view of the first player of the pairing
+int Tournament::PlayGame(const Game& game, Player* first, Player* second, std::string& moves)
+{
+    RandomStream random{game.seed_};
+    Position position{openings_[game.opening_]};
+    Player* players[2]{game.swapped_ ? second : first,
+                       game.swapped_ ? first : second};
+
+    while (!position.IsOver()){
+
+        int mover{position.player_};
+        Move move{players[mover]->Play(position, random)};
+        char notation[16]{};
+
+        if (position.InPutState()){
+
+            if (move.square_ < 0 || move.square_ >= POSITION_SQUARES || position.squares_[move.square_] != NO_PIECE)
+                return (players[mover] == first) ? -1 : 1;
+
+            position.Put(move.square_);
+            std::snprintf(notation, sizeof(notation), "s%d", move.square_);
+            moves += notation;
+        }
+        if (!position.IsOver()){
+
+            if (move.piece_ < 0 || move.piece_ >= POSITION_PIECES || !position.IsFree(move.piece_))
+                return (players[mover] == first) ? -1 : 1;
+
+            position.Pick(move.piece_);
+            std::snprintf(notation, sizeof(notation), "p%d ", move.piece_);
+            moves += notation;
+        } else {
+            moves += ' ';
+        }
+    }
+
+    if (position.quatter_ < 0)
+        return 0;
+    else
+        return (players[position.player_] == first) ? 1 : -1;
+}
+
+void Tournament::Finish(const Game& game, int result, const std::string& moves)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    Pairing& pairing{pairings_[game.pairing_]};
+    if (result > 0)
+        ++pairing.wins_;
+    else if (result < 0)
+        ++pairing.losses_;
+    else
+        ++pairing.draws_;
+    --pairing.pending_;
+    ++played_;
+
+    if (record_.is_open()){
+
+        const std::string& player1{names_[game.swapped_ ? pairing.second_ : pairing.first_]};
+        const std::string& player2{names_[game.swapped_ ? pairing.first_ : pairing.second_]};
+        const char* score{(result == 0) ? "1/2-1/2"
+                        : ((result > 0) != game.swapped_) ? "1-0" : "0-1"};
+        char line[160]{};
+        std::snprintf(line, sizeof(line), "[%s] [%s] opening=%016llx seed=%u result=%s moves=",
+                      player1.c_str(), player2.c_str(),
+                      static_cast<unsigned long long>(openings_[game.opening_].CanonicalKey()),
+                      game.seed_, score);
+        record_ << line << moves << std::endl;
+    }
+
+    if (settings_.sprt_ && pairing.verdict_.empty())
+        CheckSprt(pairing);
+
+    int games{pairing.wins_ + pairing.draws_ + pairing.losses_};
+    if (games % 100 == 0 || pairing.pending_ == 0 || !pairing.verdict_.empty()){
+
+        double score{(pairing.wins_ + 0.5 * pairing.draws_) / games};
+        double weighted{}, estimate{}, variance{};
+        Moments(pairing.wins_, pairing.draws_, pairing.losses_, weighted, estimate, variance);
+        std::printf("%s vs %s: +%d =%d -%d (%.1f%%, %+.1f Elo) %s\n",
+                    names_[pairing.first_].c_str(), names_[pairing.second_].c_str(),
+                    pairing.wins_, pairing.draws_, pairing.losses_,
+                    100.0 * score, Elo(estimate), pairing.verdict_.c_str());
+        std::fflush(stdout);
+    }
+}
+
+void Tournament::CheckSprt(Pairing& pairing)
+{
+    double llr{Llr(pairing.wins_, pairing.draws_, pairing.losses_, settings_.elo0_, settings_.elo1_)};
+    double lower{std::log(settings_.beta_ / (1.0 - settings_.alpha_))};
+    double upper{std::log((1.0 - settings_.beta_) / settings_.alpha_)};
+
+    char verdict[64]{};
+    if (llr >= upper)
+        std::snprintf(verdict, sizeof(verdict), "H1 accepted (LLR %.2f)", llr);
+    else if (llr <= lower)
+        std::snprintf(verdict, sizeof(verdict), "H0 accepted (LLR %.2f)", llr);
+
+    pairing.verdict_ = verdict;
+}
+
+void Tournament::Report() const
+{
+    std::printf("\n%-24s %-24s %7s %7s %7s %9s %17s\n",
+                "Player", "Opponent", "Wins", "Draws", "Losses", "Elo", "95%");
+
+    for (const Pairing& pairing : pairings_){
+
+        if (!(pairing.wins_ + pairing.draws_ + pairing.losses_))
+            continue;
+
+        double games{}, score{}, variance{};
+        Moments(pairing.wins_, pairing.draws_, pairing.losses_, games, score, variance);
+        double margin{1.959964 * std::sqrt(variance / games)};
+
+        std::printf("%-24s %-24s %7d %7d %7d %+9.1f [%+7.1f,%+7.1f] %s\n",
+                    names_[pairing.first_].c_str(), names_[pairing.second_].c_str(),
+                    pairing.wins_, pairing.draws_, pairing.losses_,
+                    Elo(score), Elo(score - margin), Elo(score + margin),
+                    pairing.verdict_.c_str());
+    }
+    std::printf("%d games played\n", played_);
+}
+
+double Tournament::Elo(double score)
+{
+    score = std::min(std::max(score, 1e-6), 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+//Mean score and its variance with half a game added to wins and losses. This keeps
+//the variance of lopsided pairings above zero, so their error bars stay open and
+//their likelihood ratio keeps growing until a bound is crossed
+void Tournament::Moments(int wins, int draws, int losses, double& games, double& score, double& variance)
+{
+    double won{wins + 0.5};
+    double lost{losses + 0.5};
+    games = won + draws + lost;
+    score = (won + 0.5 * draws) / games;
+    variance = (won   * std::pow(1.0 - score, 2.0)
+              + draws * std::pow(0.5 - score, 2.0)
+              + lost  * std::pow(0.0 - score, 2.0)) / games;
+}
+
+//Generalized SPRT log-likelihood ratio using the normal approximation of the mean score
+double Tournament::Llr(int wins, int draws, int losses, double elo0, double elo1)
+{
+    if (wins + draws + losses == 0)
+        return 0.0;
+
+    double games{}, score{}, variance{};
+    Moments(wins, draws, losses, games, score, variance);
+    double score0{1.0 / (1.0 + std::pow(10.0, -elo0 / 400.0))};
+    double score1{1.0 / (1.0 + std::pow(10.0, -elo1 / 400.0))};
+
+    return games * (score1 - score0) * (2.0 * score - score0 - score1) / (2.0 * variance);
+}
+
+static void PrintUsage()
+{
+    std::printf("Usage: quatter-tournament [options] player player...\n"
+                "Players:\n"
+                "  random\n"
+                "  greedy\n"
+                "  search:depth=N,time=MS,threads=N,name=NAME\n"
+                "Options:\n"
+                "  -gauntlet        Play the first player against all others\n"
+                "  -openings N      Openings per pairing, each played with both colours (100)\n"
+                "  -plies N         Random actions per opening (3)\n"
+                "  -workers N       Concurrent games (cores / threads per game)\n"
+                "  -seed N          Seed for openings and games (1)\n"
+                "  -sprt E0 E1      Stop a pairing once H0 (E0 Elo) or H1 (E1 Elo) is accepted\n"
+                "  -bounds A B      SPRT alpha and beta (0.05 0.05)\n"
+                "  -record FILE     Write every game to FILE\n");
+}
+
+int main(int argc, char** argv)
+{
+    TournamentSettings settings{false, 100, 3, 0, 1u, false, 0.0, 0.0, 0.05, 0.05, ""};
+    std::vector<std::string> specs{};
+
+    for (int a{1}; a < argc; ++a){
+
+        std::string argument{argv[a]};
+        bool hasValue{a + 1 < argc};
+
+        if (argument == "-gauntlet")
+            settings.gauntlet_ = true;
+        else if (argument == "-openings" && hasValue)
+            settings.openings_ = std::max(1, std::atoi(argv[++a]));
+        else if (argument == "-plies" && hasValue)
+            settings.openingPlies_ = std::max(0, std::atoi(argv[++a]));
+        else if (argument == "-workers" && hasValue)
+            settings.workers_ = std::atoi(argv[++a]);
+        else if (argument == "-seed" && hasValue)
+            settings.seed_ = static_cast<unsigned>(std::strtoul(argv[++a], nullptr, 10));
+        else if (argument == "-sprt" && a + 2 < argc){
+            settings.sprt_ = true;
+            settings.elo0_ = std::atof(argv[++a]);
+            settings.elo1_ = std::atof(argv[++a]);
+        } else if (argument == "-bounds" && a + 2 < argc){
+            settings.alpha_ = std::atof(argv[++a]);
+            settings.beta_ = std::atof(argv[++a]);
+        } else if (argument == "-record" && hasValue)
+            settings.recordFile_ = argv[++a];
+        else if (argument[0] == '-'){
+            PrintUsage();
+            return 1;
+        } else
+            specs.push_back(argument);
+    }
+
+    if (specs.size() < 2){
+        PrintUsage();
+        return 1;
+    }
+
+    Tournament tournament{settings, specs};
+    return tournament.Run() ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+/* Quatter
+// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "player.h"
+
+struct TournamentSettings
+{
+    bool gauntlet_;
+    int openings_;
+    int openingPlies_;
+    int workers_;
+    unsigned seed_;
+    bool sprt_;
+    double elo0_;
+    double elo1_;
+    double alpha_;
+    double beta_;
+    std::string recordFile_;
+};
+
+class Tournament
+{
+public:
+    Tournament(const TournamentSettings& settings, const std::vector<std::string>& specs);
+    bool Run();
+
+    static double Elo(double score);
+    static double Llr(int wins, int draws, int losses, double elo0, double elo1);
+private:
+    static void Moments(int wins, int draws, int losses, double& games, double& score, double& variance);
+
+    struct Pairing
+    {
+        int first_;
+        int second_;
+        int wins_;
+        int draws_;
+        int losses_;
+        int pending_;
+        std::string verdict_;
+    };
+    struct Game
+    {
+        int pairing_;
+        int opening_;
+        bool swapped_;
+        unsigned seed_;
+    };
+
+    TournamentSettings settings_;
+    std::vector<std::string> specs_;
+    std::vector<std::string> names_;
+    std::vector<Pairing> pairings_;
+    std::vector<Position> openings_;
+    std::vector<Game> games_;
+    size_t nextGame_;
+    int played_;
+    int threadsPerGame_;
+    std::mutex mutex_;
+    std::ofstream record_;
+
+    void CreatePairings();
+    void CreateOpenings();
+    void Work(int worker);
+    int PlayGame(const Game& game, Player* first, Player* second, std::string& moves);
+    void Finish(const Game& game, int result, const std::string& moves);
+    void CheckSprt(Pairing& pairing);
+    void Report() const;
+};
+
+#endif // TOURNAMENT_H
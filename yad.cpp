@@ -18,6 +18,7 @@
 
 #include "yad.h"
 #include "effectmaster.h"
+#include "lightmaster.h"
 
 void Yad::RegisterObject(Context *context)
 {
@@ -26,7 +27,6 @@ void Yad::RegisterObject(Context *context)
 
 Yad::Yad(Context* context) : LogicComponent(context),
     model_{},
-    material_{},
     light_{},
     hidden_{true},
     dimmed_{false}
@@ -40,16 +40,17 @@ void Yad::OnNodeSet(Node *node)
     node_->SetTags(tag);
     Node* lightNode{node_->CreateChild("Light")};
     lightNode->SetPosition(Vector3::UP * 0.23f);
-    model_ = node_->CreateComponent<AnimatedModel>();
-    model_->SetModel(MC->GetModel("Yad"));
-    material_ = MC->GetMaterial("Glow")->Clone();
-    model_->SetMaterial(material_);
+    model_ = node_->CreateComponent<GlowModel>();
+    model_->SetModel(MC->GetModel(MDL_YAD));
+    model_->SetMaterial(MC->GetMaterial(MAT_GLOW));
+    model_->SetColor(COLOR_GLOW);
     light_ = lightNode->CreateComponent<Light>();
     light_->SetLightType(LIGHT_POINT);
     light_->SetCastShadows(true);
     light_->SetColor(COLOR_GLOW);
     light_->SetRange(1.0f);
     light_->SetBrightness(YAD_FULLBRIGHT);
+    LIGHTS->Register(light_, 2.0f);
 
 }
 void Yad::Dim()
@@ -60,7 +61,7 @@ void Yad::Hide()
 {
     hidden_ = true;
     FX->FadeOut(light_);
-    FX->FadeOut(material_, 0.1f);
+    FX->FadeOut(model_, 0.1f);
 }
 void Yad::Reveal()
 {
@@ -70,7 +71,7 @@ void Yad::Reveal()
 void Yad::Restore()
 {
     FX->FadeTo(light_, YAD_FULLBRIGHT);
-    FX->FadeTo(material_, COLOR_GLOW, 0.1f);
+    FX->FadeTo(model_, COLOR_GLOW, 0.1f);
 }
 
 
@@ -23,6 +23,7 @@
 
 #include "mastercontrol.h"
 #include "luckey.h"
+#include "glowmodel.h"
 
 #define YAD_FULLBRIGHT 0.5f
 #define YAD_DIMMED 0.1f
@@ -36,8 +37,7 @@ public:
     static void RegisterObject(Context* context);
     virtual void OnNodeSet(Node* node);
 private:
-    SharedPtr<AnimatedModel> model_;
-    SharedPtr<Material> material_;
+    SharedPtr<GlowModel> model_;
     SharedPtr<Light> light_;
     bool hidden_;
     bool dimmed_;